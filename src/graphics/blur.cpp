@@ -16,47 +16,56 @@ Permission is granted to anyone to use this software for any purpose, including
 #include "simd.h"
 #include "threads.hpp"
 #include <libdivide.h>
-
-static std::vector<float> create_gauss_kernel(const float radius){
-	// Allocate kernel
-	const int radius_i = ::ceil(radius);
-	std::vector<float> kernel((radius_i << 1) + 1);
-	// Generate gaussian kernel (first half)
-	auto kernel_iter = kernel.begin();
-	constexpr float sqrpi2 = ::sqrt(2 * M_PI);
-	const float sigma = (radius * 2 + 1) / 3,
-		part1 = 1 / (sigma * sqrpi2),
-		sqrsigma2 = 2 * sigma * sigma;
-	for(int x = -radius_i; x <= 0; ++x)
-		*kernel_iter++ = part1 * ::exp(-(x*x) / sqrsigma2);
-	// Smooth kernel edge
-	kernel.front() *= 1 - (radius_i - radius);
-	// Complete kernel (second half)
-	std::copy(kernel.begin(), --kernel_iter, kernel.rbegin());
-	// Normalize kernel
-	const float kernel_sum_inverse = 1 / std::accumulate(kernel.begin(), kernel.end(), 0.0f);
-	for(float& kernel_value : kernel)
-		kernel_value *= kernel_sum_inverse;
-	return kernel;
-}
+#include <cmath>
+#include <numeric>
+#include <functional>
 
 namespace GUtils{
+	std::vector<float> blur_kernel(const float radius){
+		// Allocate kernel
+		const int radius_i = ::ceil(radius);
+		std::vector<float> kernel((radius_i << 1) + 1);
+		// Generate gaussian kernel (first half)
+		auto kernel_iter = kernel.begin();
+		constexpr float sqrpi2 = ::sqrt(2 * M_PI);
+		const float sigma = (radius * 2 + 1) / 3,
+			part1 = 1 / (sigma * sqrpi2),
+			sqrsigma2 = 2 * sigma * sigma;
+		for(int x = -radius_i; x <= 0; ++x)
+			*kernel_iter++ = part1 * ::exp(-(x*x) / sqrsigma2);
+		// Smooth kernel edge
+		kernel.front() *= 1 - (radius_i - radius);
+		// Complete kernel (second half)
+		std::copy(kernel.begin(), --kernel_iter, kernel.rbegin());
+		// Normalize kernel
+		const float kernel_sum_inverse = 1 / std::accumulate(kernel.begin(), kernel.end(), 0.0f);
+		for(float& kernel_value : kernel)
+			kernel_value *= kernel_sum_inverse;
+		return kernel;
+	}
+
 	void blur(unsigned char* data, const unsigned width, const unsigned height, const unsigned stride, const ColorDepth depth,
 		const float strength_h, const float strength_v){
 		// Nothing to do?
 		if(strength_h <= 0 && strength_v <= 0)
 			return;
+		// Floating point buffers (aligned for SSE loads)
+#ifdef __SSE2__
+		using FloatData = std::vector<float, AlignedAllocator<float,16>>;
+#else
+		using FloatData = std::vector<float>;
+#endif
 		// Generate filter kernels
-		std::vector<float> kernel_h, kernel_v;
-		if(strength_h > 0) kernel_h = std::move(create_gauss_kernel(strength_h));
-		if(strength_v > 0) kernel_v = strength_v == strength_h ? kernel_h : std::move(create_gauss_kernel(strength_v));
+		auto create_kernel = [](float strength){
+			const std::vector<float> kernel = blur_kernel(strength);
+			return FloatData(kernel.begin(), kernel.end());
+		};
+		FloatData kernel_h, kernel_v;
+		if(strength_h > 0) kernel_h = create_kernel(strength_h);
+		if(strength_v > 0) kernel_v = strength_v == strength_h ? kernel_h : create_kernel(strength_v);
 		// Setup buffers for data in floating point format (required for faster processing)
 		const unsigned trimmed_stride = depth == ColorDepth::X1 ? width : (depth == ColorDepth::X3 ? width * 3 : width << 2/* X4 */);
-		std::vector<float> fdata(height * trimmed_stride
-#ifdef __SSE2__
-	, 		AlignedAllocator<float,16>()
-#endif
-		), fdata2(kernel_h.empty() || kernel_v.empty() ? 0 : fdata.size()/* Don't waste memory when just one blur happens */, fdata.get_allocator());
+		FloatData fdata(height * trimmed_stride), fdata2(kernel_h.empty() || kernel_v.empty() ? 0 : fdata.size()/* Don't waste memory when just one blur happens */, fdata.get_allocator());
 		// Copy data in first FP buffer
 		if(stride == trimmed_stride)
 			fdata.assign(data, data+fdata.size());
@@ -96,7 +105,7 @@ namespace GUtils{
 									*pdata++ = std::inner_product(
 										std::max(fdata_iter - kernel_h_radius, fdata_iter_row_first),
 										std::min(fdata_iter_row_end, fdata_iter + kernel_h_radius + 1),
-										kernel_h.begin() + std::max(0, fdata_iter_row_first - (fdata_iter - kernel_h_radius)),
+										kernel_h.begin() + std::max(0, static_cast<int>(fdata_iter_row_first - (fdata_iter - kernel_h_radius))),
 										0.0f
 									);
 						};
@@ -120,7 +129,7 @@ namespace GUtils{
 #else
 										accum[0] = accum[1] = accum[2] = 0,
 #endif
-										fdata_kernel_iter = std::max(fdata_iter - kernel_h_radius * 3, fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + (kernel_h_radius + 1) * 3), kernel_iter = kernel_h.begin() + std::max(0, fdata_iter_row_first - (fdata_iter - kernel_h_radius * 3)) / 3; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 3, ++kernel_iter)
+										fdata_kernel_iter = std::max(fdata_iter - kernel_h_radius * 3, fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + (kernel_h_radius + 1) * 3), kernel_iter = kernel_h.begin() + std::max(0, static_cast<int>(fdata_iter_row_first - (fdata_iter - kernel_h_radius * 3))) / 3; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 3, ++kernel_iter)
 #ifdef __SSE2__
 										accum = _mm_add_ps(
 											accum,
@@ -165,7 +174,7 @@ namespace GUtils{
 #else
 										accum[0] = accum[1] = accum[2] = accum[3] = 0,
 #endif
-										fdata_kernel_iter = std::max(fdata_iter - (kernel_h_radius << 2), fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + ((kernel_h_radius + 1) << 2)), kernel_iter = kernel_h.begin() + (std::max(0, fdata_iter_row_first - (fdata_iter - (kernel_h_radius << 2))) >> 2); fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 4, ++kernel_iter)
+										fdata_kernel_iter = std::max(fdata_iter - (kernel_h_radius << 2), fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + ((kernel_h_radius + 1) << 2)), kernel_iter = kernel_h.begin() + (std::max(0, static_cast<int>(fdata_iter_row_first - (fdata_iter - (kernel_h_radius << 2)))) >> 2); fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 4, ++kernel_iter)
 #ifdef __SSE2__
 										accum = _mm_add_ps(
 											accum,
@@ -200,7 +209,7 @@ namespace GUtils{
 									*fdata2_iter++ = std::inner_product(
 										std::max(fdata_iter - kernel_h_radius, fdata_iter_row_first),
 										std::min(fdata_iter_row_end, fdata_iter + kernel_h_radius + 1),
-										kernel_h.begin() + std::max(0, fdata_iter_row_first - (fdata_iter - kernel_h_radius)),
+										kernel_h.begin() + std::max(0, static_cast<int>(fdata_iter_row_first - (fdata_iter - kernel_h_radius))),
 										0.0f
 									);
 						};
@@ -222,7 +231,7 @@ namespace GUtils{
 #else
 										accum[0] = accum[1] = accum[2] = 0,
 #endif
-										fdata_kernel_iter = std::max(fdata_iter - kernel_h_radius * 3, fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + (kernel_h_radius + 1) * 3), kernel_iter = kernel_h.begin() + std::max(0, fdata_iter_row_first - (fdata_iter - kernel_h_radius * 3)) / 3; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 3, ++kernel_iter)
+										fdata_kernel_iter = std::max(fdata_iter - kernel_h_radius * 3, fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + (kernel_h_radius + 1) * 3), kernel_iter = kernel_h.begin() + std::max(0, static_cast<int>(fdata_iter_row_first - (fdata_iter - kernel_h_radius * 3))) / 3; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 3, ++kernel_iter)
 #ifdef __SSE2__
 										accum = _mm_add_ps(
 											accum,
@@ -264,7 +273,7 @@ namespace GUtils{
 #else
 										accum[0] = accum[1] = accum[2] = accum[3] = 0,
 #endif
-										fdata_kernel_iter = std::max(fdata_iter - (kernel_h_radius << 2), fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + ((kernel_h_radius + 1) << 2)), kernel_iter = kernel_h.begin() + (std::max(0, fdata_iter_row_first - (fdata_iter - (kernel_h_radius << 2))) >> 2); fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 4, ++kernel_iter)
+										fdata_kernel_iter = std::max(fdata_iter - (kernel_h_radius << 2), fdata_iter_row_first), fdata_kernel_iter_end = std::min(fdata_iter_row_end, fdata_iter + ((kernel_h_radius + 1) << 2)), kernel_iter = kernel_h.begin() + (std::max(0, static_cast<int>(fdata_iter_row_first - (fdata_iter - (kernel_h_radius << 2)))) >> 2); fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += 4, ++kernel_iter)
 #ifdef __SSE2__
 										accum = _mm_add_ps(
 											accum,
@@ -308,7 +317,7 @@ namespace GUtils{
 							fdata_iter < fdata_iter_end;
 							fdata_iter += fdata_jump, pdata += data_jump)
 							for(fdata_iter_col_first = fdata_iter, fdata_iter_col_end = fdata_iter + fdatax.size(); fdata_iter != fdata_iter_col_end; fdata_iter += trimmed_stride, pdata += stride){
-								for(accum = 0, fdata_kernel_iter = std::max(fdata_iter - kernel_v_radius, fdata_iter_col_first), fdata_kernel_iter_end = std::min(fdata_iter_col_end, fdata_iter + kernel_v_radius + trimmed_stride), kernel_iter = kernel_v.begin() + std::max(0, fdata_iter_col_first - (fdata_iter - kernel_v_radius)) / trimmed_stride_div; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += trimmed_stride, ++kernel_iter)
+								for(accum = 0, fdata_kernel_iter = std::max(fdata_iter - kernel_v_radius, fdata_iter_col_first), fdata_kernel_iter_end = std::min(fdata_iter_col_end, fdata_iter + kernel_v_radius + trimmed_stride), kernel_iter = kernel_v.begin() + std::max(0, static_cast<int>(fdata_iter_col_first - (fdata_iter - kernel_v_radius))) / trimmed_stride_div; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += trimmed_stride, ++kernel_iter)
 									accum += *fdata_kernel_iter * *kernel_iter;
 								*pdata = accum;
 							}
@@ -333,7 +342,7 @@ namespace GUtils{
 #else
 									accum[0] = accum[1] = accum[2] = 0,
 #endif
-									fdata_kernel_iter = std::max(fdata_iter - kernel_v_radius, fdata_iter_col_first), fdata_kernel_iter_end = std::min(fdata_iter_col_end, fdata_iter + kernel_v_radius + trimmed_stride), kernel_iter = kernel_v.begin() + std::max(0, fdata_iter_col_first - (fdata_iter - kernel_v_radius)) / trimmed_stride_div; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += trimmed_stride, ++kernel_iter)
+									fdata_kernel_iter = std::max(fdata_iter - kernel_v_radius, fdata_iter_col_first), fdata_kernel_iter_end = std::min(fdata_iter_col_end, fdata_iter + kernel_v_radius + trimmed_stride), kernel_iter = kernel_v.begin() + std::max(0, static_cast<int>(fdata_iter_col_first - (fdata_iter - kernel_v_radius))) / trimmed_stride_div; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += trimmed_stride, ++kernel_iter)
 #ifdef __SSE2__
 									accum = _mm_add_ps(
 										accum,
@@ -378,7 +387,7 @@ namespace GUtils{
 #else
 									accum[0] = accum[1] = accum[2] = accum[3] = 0,
 #endif
-									fdata_kernel_iter = std::max(fdata_iter - kernel_v_radius, fdata_iter_col_first), fdata_kernel_iter_end = std::min(fdata_iter_col_end, fdata_iter + kernel_v_radius + trimmed_stride), kernel_iter = kernel_v.begin() + std::max(0, fdata_iter_col_first - (fdata_iter - kernel_v_radius)) / trimmed_stride_div; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += trimmed_stride, ++kernel_iter)
+									fdata_kernel_iter = std::max(fdata_iter - kernel_v_radius, fdata_iter_col_first), fdata_kernel_iter_end = std::min(fdata_iter_col_end, fdata_iter + kernel_v_radius + trimmed_stride), kernel_iter = kernel_v.begin() + std::max(0, static_cast<int>(fdata_iter_col_first - (fdata_iter - kernel_v_radius))) / trimmed_stride_div; fdata_kernel_iter != fdata_kernel_iter_end; fdata_kernel_iter += trimmed_stride, ++kernel_iter)
 #ifdef __SSE2__
 									accum = _mm_add_ps(
 										accum,
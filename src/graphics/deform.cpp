@@ -0,0 +1,112 @@
+/*
+Project: SSBRenderer
+File: deform.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "gutils.hpp"
+#include "expression.hpp"
+#include "pathcache.hpp"
+#include <config.h>
+#include <cmath>
+
+// Compiled formulas + variables memory
+struct DeformPack{
+	GUtils::Expression x_expression, y_expression;
+	std::vector<double> x, y, t, x_result, y_result;
+	DeformPack(const std::string& x_formula, const std::string& y_formula)
+	: x_expression(x_formula, {"x", "y", "t"}), y_expression(y_formula, {"x", "y", "t"}){}
+};
+static DeformPack& get_deform_pack(const std::string& x_formula, const std::string& y_formula){
+	static thread_local stdex::Cache<std::pair<std::string,std::string>, std::shared_ptr<DeformPack>, DEFORM_FORMULAS> deforms_cache;	// Cache for reusable formulas (per thread, no locking)
+	std::pair<std::string,std::string> formula(x_formula, y_formula);
+	if(deforms_cache.contains(formula))
+		return *deforms_cache.get(formula);
+	std::shared_ptr<DeformPack> deform = std::make_shared<DeformPack>(x_formula, y_formula);
+	deforms_cache.add(formula, deform);
+	return *deform;
+}
+
+// Formulas & quantized progress as deform cache parameters
+struct DeformParams{
+	double tolerance;
+	std::string x_formula, y_formula;
+	long progress_step;
+	bool operator==(const DeformParams& other) const{
+		return this->tolerance == other.tolerance && this->x_formula == other.x_formula && this->y_formula == other.y_formula &&
+			this->progress_step == other.progress_step;
+	}
+};
+struct DeformParamsHash{
+	size_t operator()(const DeformParams& params) const{
+		size_t hash = std::hash<double>()(params.tolerance);
+		GUtils::hash_combine(hash, std::hash<std::string>()(params.x_formula)),
+		GUtils::hash_combine(hash, std::hash<std::string>()(params.y_formula)),
+		GUtils::hash_combine(hash, std::hash<long>()(params.progress_step));
+		return hash;
+	}
+};
+
+namespace GUtils{
+	void path_deform(std::vector<PathSegment>& path, const std::string& x_formula, const std::string& y_formula, double progress){
+		// Pick formulas
+		DeformPack& deform = get_deform_pack(x_formula, y_formula);
+		// Collect path points
+		deform.x.clear(),
+		deform.y.clear();
+		for(const PathSegment& segment : path)
+			if(segment.type != PathSegment::Type::CLOSE)
+				deform.x.push_back(segment.x),
+				deform.y.push_back(segment.y);
+		const size_t n = deform.x.size();
+		deform.t.assign(n, progress),
+		deform.x_result.resize(n),
+		deform.y_result.resize(n);
+		// Apply formulas to all path points at once
+		const double* const values[] = {deform.x.data(), deform.y.data(), deform.t.data()};
+		if(!deform.x_expression.evaluate(values, deform.x_result.data(), n) ||
+			!deform.y_expression.evaluate(values, deform.y_result.data(), n))
+			return;
+		size_t point_i = 0;
+		for(PathSegment& segment : path)
+			if(segment.type != PathSegment::Type::CLOSE)
+				segment.x = deform.x_result[point_i],
+				segment.y = deform.y_result[point_i++];
+	}
+
+	void path_deform(Path& path, const std::string& x_formula, const std::string& y_formula, double progress){
+		// Pick formulas
+		DeformPack& deform = get_deform_pack(x_formula, y_formula);
+		// Apply formulas to path coordinates directly (closes repeat previous points, so they deform alike)
+		const size_t n = path.size();
+		deform.t.assign(n, progress),
+		deform.x_result.resize(n),
+		deform.y_result.resize(n);
+		const double* const values[] = {path.x_data(), path.y_data(), deform.t.data()};
+		if(!deform.x_expression.evaluate(values, deform.x_result.data(), n) ||
+			!deform.y_expression.evaluate(values, deform.y_result.data(), n))
+			return;
+		std::copy(deform.x_result.begin(), deform.x_result.end(), path.x_data()),
+		std::copy(deform.y_result.begin(), deform.y_result.end(), path.y_data());
+	}
+
+	std::shared_ptr<const std::vector<PathSegment>> path_deform_cached(const std::vector<PathSegment>& path, double tolerance,
+			const std::string& x_formula, const std::string& y_formula, double progress){
+		static PathCache<DeformParams, DeformParamsHash> deformed_cache(static_cast<size_t>(DEFORM_CACHE_SIZE) << 20);
+		// Missing formula keeps coordinate
+		return deformed_cache.get(path, {tolerance, x_formula.empty() ? "x" : x_formula, y_formula.empty() ? "y" : y_formula, std::lround(progress * DEFORM_STEPS)},
+			[](const std::vector<PathSegment>& source, const DeformParams& params){
+				std::vector<PathSegment> deformed(source);
+				path_deform(path_flatten(deformed, params.tolerance), params.x_formula, params.y_formula, static_cast<double>(params.progress_step) / DEFORM_STEPS);
+				return deformed;
+			});
+	}
+}
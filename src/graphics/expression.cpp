@@ -0,0 +1,353 @@
+/*
+Project: SSBRenderer
+File: expression.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "expression.hpp"
+#include <muParser.h>
+#include "../utils/string.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <exception>
+
+// Operations on operand values a, b & c (muParser semantics)
+#define EXPRESSION_OPS(OP) \
+	OP(NEG, -a) \
+	OP(ADD, a + b) \
+	OP(SUB, a - b) \
+	OP(MUL, a * b) \
+	OP(DIV, a / b) \
+	OP(POW, std::pow(a, b)) \
+	OP(LT, static_cast<double>(a < b)) \
+	OP(GT, static_cast<double>(a > b)) \
+	OP(LE, static_cast<double>(a <= b)) \
+	OP(GE, static_cast<double>(a >= b)) \
+	OP(EQ, static_cast<double>(a == b)) \
+	OP(NE, static_cast<double>(a != b)) \
+	OP(AND, static_cast<double>(a != 0 && b != 0)) \
+	OP(OR, static_cast<double>(a != 0 || b != 0)) \
+	OP(SELECT, a != 0 ? b : c) \
+	OP(MIN, std::min(a, b)) \
+	OP(MAX, std::max(a, b)) \
+	OP(SIN, std::sin(a)) \
+	OP(COS, std::cos(a)) \
+	OP(TAN, std::tan(a)) \
+	OP(ASIN, std::asin(a)) \
+	OP(ACOS, std::acos(a)) \
+	OP(ATAN, std::atan(a)) \
+	OP(SINH, std::sinh(a)) \
+	OP(COSH, std::cosh(a)) \
+	OP(TANH, std::tanh(a)) \
+	OP(ASINH, std::asinh(a)) \
+	OP(ACOSH, std::acosh(a)) \
+	OP(ATANH, std::atanh(a)) \
+	OP(LOG2, std::log2(a)) \
+	OP(LOG10, std::log10(a)) \
+	OP(LN, std::log(a)) \
+	OP(EXP, std::exp(a)) \
+	OP(SQRT, std::sqrt(a)) \
+	OP(SIGN, static_cast<double>((a > 0) - (a < 0))) \
+	OP(RINT, std::floor(a + 0.5)) \
+	OP(ABS, std::fabs(a))
+
+// Formula syntax not compilable
+class SyntaxError : public std::exception{
+	private:
+		std::string message;
+	public:
+		SyntaxError(const std::string& message) : message(message){}
+		const char* what() const noexcept override{return this->message.c_str();}
+};
+
+namespace GUtils{
+	// Recursive descent parser emitting instructions (constant operands get folded)
+	class Expression::Compiler{
+		private:
+			const char* it;
+			const char* const end;
+			const std::vector<std::string>& variables;
+			std::vector<Instruction>& code;
+			bool powered = false;	// Last operand was a power
+			// Token helpers
+			void skip_space(){
+				while(it != end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n'))
+					++it;
+			}
+			bool accept(const char* token){
+				this->skip_space();
+				const size_t token_size = std::strlen(token);
+				if(static_cast<size_t>(end - it) >= token_size && std::equal(token, token + token_size, it)){
+					it += token_size;
+					return true;
+				}
+				return false;
+			}
+			// Instruction output
+			static double apply(OpCode op, double a, double b, double c){
+				switch(op){
+#define SCALAR_CASE(name, expr) case OpCode::name: return expr;
+					EXPRESSION_OPS(SCALAR_CASE)
+#undef SCALAR_CASE
+					case OpCode::CONST:
+					case OpCode::VAR: break;
+				}
+				return 0;
+			}
+			unsigned emit(OpCode op, unsigned a = 0, unsigned b = 0, unsigned c = 0, double value = 0){
+				if(op != OpCode::CONST && op != OpCode::VAR){
+					// Missing operands reference first one
+					if(op != OpCode::SELECT){
+						c = a;
+						if(op < OpCode::ADD || op > OpCode::MAX)
+							b = a;
+					}
+					if(this->code[a].op == OpCode::CONST && this->code[b].op == OpCode::CONST && this->code[c].op == OpCode::CONST)
+						value = apply(op, this->code[a].value, this->code[b].value, this->code[c].value),
+						op = OpCode::CONST;
+				}
+				this->code.push_back({op, a, b, c, value});
+				return static_cast<unsigned>(this->code.size() - 1);
+			}
+			// Grammar by operator precedence
+			unsigned ternary(){
+				const unsigned condition = this->logic_or();
+				if(this->accept("?")){
+					const unsigned a = this->ternary();
+					if(!this->accept(":"))
+						throw SyntaxError("Expected ':'");
+					const unsigned b = this->ternary();
+					return this->emit(OpCode::SELECT, condition, a, b);
+				}
+				return condition;
+			}
+			unsigned logic_or(){
+				unsigned result = this->logic_and();
+				while(this->accept("||"))
+					result = this->emit(OpCode::OR, result, this->logic_and());
+				return result;
+			}
+			unsigned logic_and(){
+				unsigned result = this->compare();
+				while(this->accept("&&"))
+					result = this->emit(OpCode::AND, result, this->compare());
+				return result;
+			}
+			unsigned compare(){
+				unsigned result = this->add();
+				while(true)
+					if(this->accept("<="))
+						result = this->emit(OpCode::LE, result, this->add());
+					else if(this->accept(">="))
+						result = this->emit(OpCode::GE, result, this->add());
+					else if(this->accept("=="))
+						result = this->emit(OpCode::EQ, result, this->add());
+					else if(this->accept("!="))
+						result = this->emit(OpCode::NE, result, this->add());
+					else if(this->accept("<"))
+						result = this->emit(OpCode::LT, result, this->add());
+					else if(this->accept(">"))
+						result = this->emit(OpCode::GT, result, this->add());
+					else
+						return result;
+			}
+			unsigned add(){
+				unsigned result = this->multiply();
+				while(true)
+					if(this->accept("+"))
+						result = this->emit(OpCode::ADD, result, this->multiply());
+					else if(this->accept("-"))
+						result = this->emit(OpCode::SUB, result, this->multiply());
+					else
+						return result;
+			}
+			unsigned multiply(){
+				unsigned result = this->unary();
+				while(true)
+					if(this->accept("*"))
+						result = this->emit(OpCode::MUL, result, this->unary());
+					else if(this->accept("/"))
+						result = this->emit(OpCode::DIV, result, this->unary());
+					else
+						return result;
+			}
+			unsigned unary(){
+				if(this->accept("-")){
+					const unsigned operand = this->unary();
+					if(this->powered)
+						throw SyntaxError("Sign of power differs between muParser versions");
+					return this->emit(OpCode::NEG, operand);
+				}else if(this->accept("+"))
+					return this->unary();
+				return this->power();
+			}
+			unsigned power(){
+				const unsigned base = this->primary();
+				this->powered = false;
+				if(this->accept("^")){
+					const unsigned exponent = this->accept("-") ? this->emit(OpCode::NEG, this->primary()) : (this->accept("+"), this->primary());
+					if(this->accept("^"))
+						throw SyntaxError("Power associativity differs between muParser versions");
+					this->powered = true;
+					return this->emit(OpCode::POW, base, exponent);
+				}
+				return base;
+			}
+			unsigned primary(){
+				this->skip_space();
+				if(it == end)
+					throw SyntaxError("Operand expected");
+				// Number
+				if((*it >= '0' && *it <= '9') || *it == '.'){
+					double value;
+					if(stdex::parse_number(it, end, value) != stdex::NumberStatus::OK)
+						throw SyntaxError("Invalid number");
+					return this->emit(OpCode::CONST, 0, 0, 0, value);
+				}
+				// Brackets
+				if(this->accept("(")){
+					const unsigned result = this->ternary();
+					if(!this->accept(")"))
+						throw SyntaxError("Expected ')'");
+					return result;
+				}
+				// Identifier
+				const char* const name_start = it;
+				while(it != end && ((*it >= 'a' && *it <= 'z') || (*it >= 'A' && *it <= 'Z') || (*it >= '0' && *it <= '9') || *it == '_'))
+					++it;
+				const std::string name(name_start, it);
+				if(name.empty())
+					throw SyntaxError("Unexpected character");
+				auto variable = std::find(this->variables.begin(), this->variables.end(), name);
+				if(variable != this->variables.end())
+					return this->emit(OpCode::VAR, static_cast<unsigned>(variable - this->variables.begin()));
+				if(name == "_pi")
+					return this->emit(OpCode::CONST, 0, 0, 0, M_PI);
+				if(name == "_e")
+					return this->emit(OpCode::CONST, 0, 0, 0, M_E);
+				// Function call
+				if(!this->accept("("))
+					throw SyntaxError("Unknown identifier");
+				std::vector<unsigned> args{this->ternary()};
+				while(this->accept(","))
+					args.push_back(this->ternary());
+				if(!this->accept(")"))
+					throw SyntaxError("Expected ')'");
+				static const std::pair<const char*, OpCode> functions[] = {
+					{"sin", OpCode::SIN}, {"cos", OpCode::COS}, {"tan", OpCode::TAN},
+					{"asin", OpCode::ASIN}, {"acos", OpCode::ACOS}, {"atan", OpCode::ATAN},
+					{"sinh", OpCode::SINH}, {"cosh", OpCode::COSH}, {"tanh", OpCode::TANH},
+					{"asinh", OpCode::ASINH}, {"acosh", OpCode::ACOSH}, {"atanh", OpCode::ATANH},
+					{"log2", OpCode::LOG2}, {"log10", OpCode::LOG10}, {"ln", OpCode::LN}, {"exp", OpCode::EXP},
+					{"sqrt", OpCode::SQRT}, {"sign", OpCode::SIGN}, {"rint", OpCode::RINT}, {"abs", OpCode::ABS}
+				};
+				for(const auto& function : functions)
+					if(name == function.first){
+						if(args.size() != 1)
+							throw SyntaxError("Function expects one argument");
+						return this->emit(function.second, args.front());
+					}
+				// Functions with variable arguments number ('log' is left to muParser, its base differs between versions)
+				unsigned result = args.front();
+				if(name == "min" || name == "max"){
+					for(size_t arg_i = 1; arg_i < args.size(); ++arg_i)
+						result = this->emit(name == "min" ? OpCode::MIN : OpCode::MAX, result, args[arg_i]);
+					return result;
+				}
+				if(name == "sum" || name == "avg"){
+					for(size_t arg_i = 1; arg_i < args.size(); ++arg_i)
+						result = this->emit(OpCode::ADD, result, args[arg_i]);
+					return name == "sum" ? result : this->emit(OpCode::MUL, result, this->emit(OpCode::CONST, 0, 0, 0, 1.0 / args.size()));
+				}
+				throw SyntaxError("Unknown function");
+			}
+		public:
+			Compiler(const std::string& formula, const std::vector<std::string>& variables, std::vector<Instruction>& code)
+			: it(formula.data()), end(formula.data() + formula.size()), variables(variables), code(code){}
+			unsigned compile(){
+				const unsigned result = this->ternary();
+				this->skip_space();
+				if(it != end)
+					throw SyntaxError("Unexpected character");
+				return result;
+			}
+	};
+
+	Expression::Expression(const std::string& formula, const std::vector<std::string>& variables) : variables(variables){
+		try{
+			this->result = Compiler(formula, variables, this->code).compile(),
+			this->registers.resize(this->code.size());
+			for(size_t code_i = 0; code_i < this->code.size(); ++code_i)
+				if(this->code[code_i].op == OpCode::CONST)
+					std::fill_n(this->registers[code_i].values, lanes, this->code[code_i].value);
+		}catch(const SyntaxError&){
+			// Leave unsupported (or invalid) formula to muParser
+			this->code.clear(),
+			this->registers.clear(),
+			this->fallback.reset(new mu::Parser),
+			this->fallback_values.resize(variables.size()),
+			this->fallback->SetExpr(formula);
+		}
+	}
+
+	Expression::~Expression() = default;
+
+	bool Expression::evaluate(const double* const* values, double* results, size_t n){
+		if(n == 0)
+			return true;
+		if(this->fallback)
+			return this->evaluate_fallback(values, results, n);
+		// Run code on lanes of values
+		std::vector<Lane>& registers = this->registers;
+		for(size_t base = 0; base < n; base += lanes){
+			const size_t count = std::min<size_t>(lanes, n - base);
+			for(size_t code_i = 0; code_i < this->code.size(); ++code_i){
+				const Instruction& instruction = this->code[code_i];
+				double* const dst = registers[code_i].values;
+				const double* const src_a = registers[instruction.a].values,
+					*const src_b = registers[instruction.b].values,
+					*const src_c = registers[instruction.c].values;
+				switch(instruction.op){
+					case OpCode::CONST:
+						break;
+					case OpCode::VAR:
+						std::copy_n(values[instruction.a] + base, count, dst);
+						break;
+#define LANES_CASE(name, expr) case OpCode::name: for(unsigned lane = 0; lane < lanes; ++lane){const double a = src_a[lane], b = src_b[lane], c = src_c[lane]; static_cast<void>(b), static_cast<void>(c); dst[lane] = expr;} break;
+					EXPRESSION_OPS(LANES_CASE)
+#undef LANES_CASE
+				}
+			}
+			std::copy_n(registers[this->result].values, count, results + base);
+		}
+		return true;
+	}
+
+	bool Expression::evaluate_fallback(const double* const* values, double* results, size_t n){
+		// Copy values into parser memory (variables bound again on growth)
+		if(this->fallback_values.empty() || n > this->fallback_values.front().size()){
+			const size_t size = std::max(n, this->fallback_values.empty() ? 0 : this->fallback_values.front().size() * 2);
+			for(size_t variable_i = 0; variable_i < this->fallback_values.size(); ++variable_i)
+				this->fallback_values[variable_i].resize(size),
+				this->fallback->DefineVar(this->variables[variable_i], this->fallback_values[variable_i].data());
+		}
+		for(size_t variable_i = 0; variable_i < this->fallback_values.size(); ++variable_i)
+			std::copy_n(values[variable_i], n, this->fallback_values[variable_i].begin());
+		// Evaluate all values at once
+		try{
+			this->fallback->Eval(results, static_cast<int>(n));
+		}catch(...){
+			return false;
+		}
+		return true;
+	}
+}
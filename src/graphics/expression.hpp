@@ -0,0 +1,71 @@
+/*
+Project: SSBRenderer
+File: expression.hpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace mu{
+	class Parser;
+}
+
+namespace GUtils{
+	// Formula in muParser syntax, compiled once to register code & evaluated on arrays of variable values (muParser for unsupported syntax)
+	class Expression{
+		public:
+			// Values per register (instruction loops over them get vectorized)
+			static constexpr unsigned lanes = 8;
+		private:
+			enum class OpCode : unsigned char{
+				CONST, VAR,
+				NEG, ADD, SUB, MUL, DIV, POW,
+				LT, GT, LE, GE, EQ, NE, AND, OR, SELECT,
+				MIN, MAX,
+				SIN, COS, TAN, ASIN, ACOS, ATAN, SINH, COSH, TANH, ASINH, ACOSH, ATANH,
+				LOG2, LOG10, LN, EXP, SQRT, SIGN, RINT, ABS
+			};
+			// Instruction writes register of own index (a=variable index for VAR)
+			struct Instruction{
+				OpCode op;
+				unsigned a, b, c;
+				double value;
+			};
+			std::vector<Instruction> code;
+			unsigned result = 0;	// Register of formula result
+			// Register memory for evaluation, allocated & filled with constants on compile
+			struct Lane{
+				double values[lanes];
+			};
+			std::vector<Lane> registers;
+			class Compiler;
+			// Fallback with own variable memory
+			std::unique_ptr<mu::Parser> fallback;
+			std::vector<std::vector<double>> fallback_values;
+			const std::vector<std::string> variables;
+			bool evaluate_fallback(const double* const* values, double* results, size_t n);
+		public:
+			// Compile formula with variable names (in order of evaluation values)
+			Expression(const std::string& formula, const std::vector<std::string>& variables);
+			~Expression();
+			// Formula compiled (no muParser needed)?
+			bool compiled() const{return !this->fallback;}
+			// Evaluate formula for n sets of variable values (one array per variable), false on evaluation error
+			bool evaluate(const double* const* values, double* results, size_t n);
+			// No copy (-> fallback parser)
+			Expression(const Expression&) = delete;
+			Expression& operator=(const Expression&) = delete;
+	};
+}
@@ -25,6 +25,10 @@ Permission is granted to anyone to use this software for any purpose, including
 #include <exception>
 #include <vector>
 #include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <memory>
 
 namespace GUtils{
 	// 4x4 double-precision floating point matrix for transformations
@@ -65,6 +69,9 @@ namespace GUtils{
 			double* transform2d(double* vec);
 			double* transform3d(double* vec);
 			double* transform4d(double* vec);
+			// Batch 2D transformations (affine part like transform2d) of coordinate arrays or points with byte stride
+			void transform2d(double* xs, double* ys, size_t n);
+			void transform2d(double* vecs, size_t n, size_t stride = sizeof(double) << 1);
 			// Unary operations
 			Matrix4x4d& identity();
 			bool invert();
@@ -139,6 +146,8 @@ namespace GUtils{
 	enum class ColorDepth{X1/* A */, X3/* RGB */, X4/* RGBA */};
 	void blur(unsigned char* data, const unsigned width, const unsigned height, const unsigned stride, const ColorDepth depth,
 		const float strength_h, const float strength_v);
+	// Normalized gaussian weights for blur strength (2*ceil(radius)+1 values)
+	std::vector<float> blur_kernel(const float radius);
 
 	// Path processing
 #pragma pack(push,1)	// Ensure coordinates are aligned (for passing them as continuous memory) and memory usage is low
@@ -153,6 +162,123 @@ namespace GUtils{
 	std::vector<PathSegment>& path_transform(std::vector<PathSegment>& path, Matrix4x4d& mat);
 	std::vector<PathSegment> path_by_arc(double x, double y, double cx, double cy, double angle);
 
+	// Allocator for SIMD aligned memory
+	template<typename T, size_t ALIGN = 32>
+	struct AlignedAllocator{
+		using value_type = T;
+		template<typename U>
+		struct rebind{using other = AlignedAllocator<U,ALIGN>;};
+		AlignedAllocator() = default;
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U,ALIGN>&){}
+		T* allocate(size_t n){
+			// Over-allocate & store original address in front of aligned memory
+			void* const raw = std::malloc(n * sizeof(T) + ALIGN + sizeof(void*));
+			if(!raw) throw std::bad_alloc();
+			void** const aligned = reinterpret_cast<void**>((reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + ALIGN - 1) & ~static_cast<uintptr_t>(ALIGN - 1));
+			aligned[-1] = raw;
+			return reinterpret_cast<T*>(aligned);
+		}
+		void deallocate(T* p, size_t){
+			std::free(reinterpret_cast<void**>(p)[-1]);
+		}
+		template<typename U>
+		bool operator==(const AlignedAllocator<U,ALIGN>&) const{return true;}
+		template<typename U>
+		bool operator!=(const AlignedAllocator<U,ALIGN>&) const{return false;}
+	};
+
+	// Path with segment types & coordinates in separate aligned arrays (closes repeat previous point, so all coordinates are valid)
+	class Path{
+		private:
+			std::vector<PathSegment::Type> types;
+			std::vector<double, AlignedAllocator<double>> xs, ys;
+		public:
+			// Ctors & conversion to segments
+			Path() = default;
+			Path(const std::vector<PathSegment>& segments);
+			std::vector<PathSegment> segments() const;
+			// Size
+			size_t size() const{return this->types.size();}
+			bool empty() const{return this->types.empty();}
+			void reserve(size_t n){
+				this->types.reserve(n),
+				this->xs.reserve(n),
+				this->ys.reserve(n);
+			}
+			void clear(){
+				this->types.clear(),
+				this->xs.clear(),
+				this->ys.clear();
+			}
+			// Append segment
+			void push_back(PathSegment::Type type, double x, double y){
+				this->types.push_back(type),
+				this->xs.push_back(x),
+				this->ys.push_back(y);
+			}
+			void close(){
+				this->push_back(PathSegment::Type::CLOSE, this->xs.empty() ? 0 : this->xs.back(), this->ys.empty() ? 0 : this->ys.back());
+			}
+			// Raw data access
+			const PathSegment::Type* type_data() const{return this->types.data();}
+			double* x_data() const{return const_cast<double*>(this->xs.data());}
+			double* y_data() const{return const_cast<double*>(this->ys.data());}
+	};
+	bool path_extents(const Path& path, double* x0, double* y0, double* x1, double* y1);
+	Path& path_flatten(Path& path, double tolerance);
+	Path& path_transform(Path& path, Matrix4x4d& mat);
+
+	// Rasterize path (curves taken as lines, so flatten before) to anti-aliased coverage mask (A8) of its pixel-aligned bounding box at mask_x & mask_y
+	enum class FillRule{NONZERO, EVENODD};
+	Image2D<> path_rasterize(const std::vector<PathSegment>& path, FillRule rule, int& mask_x, int& mask_y);
+	Image2D<> path_rasterize(const Path& path, FillRule rule, int& mask_x, int& mask_y);
+	// Same, but mask limited to clip box (costs by visible area of huge paths)
+	Image2D<> path_rasterize(const std::vector<PathSegment>& path, FillRule rule, int clip_x, int clip_y, unsigned clip_width, unsigned clip_height, int& mask_x, int& mask_y);
+	Image2D<> path_rasterize(const Path& path, FillRule rule, int clip_x, int clip_y, unsigned clip_width, unsigned clip_height, int& mask_x, int& mask_y);
+
+	// Deform path points by formulas (muParser syntax) of variables x, y & progress t
+	void path_deform(std::vector<PathSegment>& path, const std::string& x_formula, const std::string& y_formula, double progress);
+	void path_deform(Path& path, const std::string& x_formula, const std::string& y_formula, double progress);
+	// Flatten & deform path, reusing results of equal path, formulas & progress quantized to DEFORM_STEPS (shared by all threads within DEFORM_CACHE_SIZE; empty formula keeps coordinate)
+	std::shared_ptr<const std::vector<PathSegment>> path_deform_cached(const std::vector<PathSegment>& path, double tolerance,
+					const std::string& x_formula, const std::string& y_formula, double progress);
+
+	// Stroke path (curves taken as lines, so flatten before) to outline for nonzero filling, dashes alternate on & off lengths
+	enum class LineJoin{ROUND, BEVEL, MITER};
+	enum class LineCap{ROUND, SQUARE, FLAT};
+	std::vector<PathSegment> path_stroke(const std::vector<PathSegment>& path, double width, LineJoin join, LineCap cap,
+					double dash_offset = 0, const std::vector<double>& dashes = {});
+	// Stroke path like above, reusing outlines of equal path & line style (shared by all threads within STROKE_CACHE_SIZE)
+	std::shared_ptr<const std::vector<PathSegment>> path_stroke_cached(const std::vector<PathSegment>& path, double width, LineJoin join, LineCap cap,
+					double dash_offset = 0, const std::vector<double>& dashes = {});
+
+	// Sparse coverage (A8) of touched rows as spans, for stencil operations costing by touched area instead of image size
+	class SpanMask{
+		public:
+			// Horizontal run of constant coverage in [x0,x1)
+			struct Span{
+				int x0, x1;
+				unsigned char coverage;
+			};
+		private:
+			// Spans by row, starting with first touched one (uncovered parts without spans)
+			int row_first = 0;
+			std::vector<std::vector<Span>> rows;
+			template<typename Op>
+			void combine(const Image2D<>& mask, int mask_x, int mask_y, Op op);
+		public:
+			// Add & remove coverage of mask positioned at mask_x & mask_y
+			void unite(const Image2D<>& mask, int mask_x, int mask_y);
+			void subtract(const Image2D<>& mask, int mask_x, int mask_y);
+			// Reduce mask coverage to inside or outside of this one
+			void clip(Image2D<>& mask, int mask_x, int mask_y, bool inside) const;
+			// Coverage at position
+			unsigned char get(int x, int y) const;
+			bool empty() const{return this->rows.empty();}
+			void clear(){this->rows.clear(), this->row_first = 0;}
+	};
+
 	// Exception for font problems (see Font class below)
 	class FontException : public std::exception{
 		private:
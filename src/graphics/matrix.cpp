@@ -296,8 +296,8 @@ namespace GUtils{
 		__m128d m_temp2 = _mm_add_pd(
 			_mm256_extractf128_pd(m_temp, 0x0),
 			_mm256_extractf128_pd(m_temp, 0x1)
-		),
-		vec[3] = *reinterpret_cast<double*>(&m_temp2) + reinterpret_cast<double*>(&m_temp2)[1]
+		);
+		vec[2] = *reinterpret_cast<double*>(&m_temp2) + reinterpret_cast<double*>(&m_temp2)[1];
 #elif defined __SSE3__
 		__m128d m_vec = _mm_loadu_pd(vec);
 		_mm_storeu_pd(
@@ -445,6 +445,71 @@ namespace GUtils{
 #endif
 		return vec;
 	}
+	void Matrix4x4d::transform2d(double* xs, double* ys, size_t n){
+		// Affine 2D part of matrix
+		const double m0 = this->matrix[0], m1 = this->matrix[1], m3 = this->matrix[3],
+			m4 = this->matrix[4], m5 = this->matrix[5], m7 = this->matrix[7];
+		size_t i = 0;
+#ifdef __AVX__
+		// 4 points per operation
+		const __m256d m_m0 = _mm256_set1_pd(m0), m_m1 = _mm256_set1_pd(m1), m_m3 = _mm256_set1_pd(m3),
+			m_m4 = _mm256_set1_pd(m4), m_m5 = _mm256_set1_pd(m5), m_m7 = _mm256_set1_pd(m7);
+		for(; i + 4 <= n; i += 4){
+			const __m256d m_x = _mm256_loadu_pd(xs+i),
+				m_y = _mm256_loadu_pd(ys+i);
+			_mm256_storeu_pd(xs+i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m_m0, m_x), _mm256_mul_pd(m_m1, m_y)), m_m3)),
+			_mm256_storeu_pd(ys+i, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m_m4, m_x), _mm256_mul_pd(m_m5, m_y)), m_m7));
+		}
+#elif defined __SSE2__
+		// 2 points per operation
+		const __m128d m_m0 = _mm_set1_pd(m0), m_m1 = _mm_set1_pd(m1), m_m3 = _mm_set1_pd(m3),
+			m_m4 = _mm_set1_pd(m4), m_m5 = _mm_set1_pd(m5), m_m7 = _mm_set1_pd(m7);
+		for(; i + 2 <= n; i += 2){
+			const __m128d m_x = _mm_loadu_pd(xs+i),
+				m_y = _mm_loadu_pd(ys+i);
+			_mm_storeu_pd(xs+i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(m_m0, m_x), _mm_mul_pd(m_m1, m_y)), m_m3)),
+			_mm_storeu_pd(ys+i, _mm_add_pd(_mm_add_pd(_mm_mul_pd(m_m4, m_x), _mm_mul_pd(m_m5, m_y)), m_m7));
+		}
+#endif
+		// Remaining points
+		for(; i < n; ++i){
+			const double x = xs[i], y = ys[i];
+			xs[i] = m0 * x + m1 * y + m3,
+			ys[i] = m4 * x + m5 * y + m7;
+		}
+	}
+	void Matrix4x4d::transform2d(double* vecs, size_t n, size_t stride){
+		unsigned char* vec = reinterpret_cast<unsigned char*>(vecs);
+#ifdef __SSE2__
+		// Matrix columns -> point by 2 multiplications & additions
+		const __m128d m_col0 = _mm_set_pd(this->matrix[4], this->matrix[0]),
+			m_col1 = _mm_set_pd(this->matrix[5], this->matrix[1]),
+			m_col3 = _mm_set_pd(this->matrix[7], this->matrix[3]);
+		for(const unsigned char* const vec_end = vec + n * stride; vec != vec_end; vec += stride){
+			double* const xy = reinterpret_cast<double*>(vec);
+			const __m128d m_vec = _mm_loadu_pd(xy);
+			_mm_storeu_pd(
+				xy,
+				_mm_add_pd(
+					_mm_add_pd(
+						_mm_mul_pd(m_col0, _mm_unpacklo_pd(m_vec, m_vec)),
+						_mm_mul_pd(m_col1, _mm_unpackhi_pd(m_vec, m_vec))
+					),
+					m_col3
+				)
+			);
+		}
+#else
+		const double m0 = this->matrix[0], m1 = this->matrix[1], m3 = this->matrix[3],
+			m4 = this->matrix[4], m5 = this->matrix[5], m7 = this->matrix[7];
+		for(const unsigned char* const vec_end = vec + n * stride; vec != vec_end; vec += stride){
+			double* const xy = reinterpret_cast<double*>(vec);
+			const double x = xy[0], y = xy[1];
+			xy[0] = m0 * x + m1 * y + m3,
+			xy[1] = m4 * x + m5 * y + m7;
+		}
+#endif
+	}
 	Matrix4x4d& Matrix4x4d::identity(){
 		static const double identity_matrix[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
 		std::copy(identity_matrix, identity_matrix+16, this->matrix);
@@ -596,7 +661,7 @@ namespace GUtils{
 			_mm256_set_pd(this->matrix[8], this->matrix[13], this->matrix[12], this->matrix[13])
 		);
 		// Delta
-		__m256d m_delta = _mm256_mul_pd(_mm256_load_pd(this->matrix), _mm256_set_pd(inv_matrix[12]), inv_matrix[8], inv_matrix[4], inv_matrix[0]);
+		__m256d m_delta = _mm256_mul_pd(_mm256_load_pd(this->matrix), _mm256_set_pd(inv_matrix[12], inv_matrix[8], inv_matrix[4], inv_matrix[0]));
 		double delta = *reinterpret_cast<double*>(&m_delta) + reinterpret_cast<double*>(&m_delta)[1] + reinterpret_cast<double*>(&m_delta)[2] + reinterpret_cast<double*>(&m_delta)[3];
 		if(delta != 0.0){
 			m_delta = _mm256_set1_pd(1 / delta);
@@ -13,7 +13,7 @@ Permission is granted to anyone to use this software for any purpose, including
 */
 
 #include "gutils.hpp"
-#include <array>
+#include <cmath>
 #include "simd.h"
 
 // Rotation helpers
@@ -55,92 +55,38 @@ static double angle_vec_x_vec(double v0x, double v0y, double v1x, double v1y){
 	return ::acos((v0x * v1x + v0y * v1y) / (::hypot(v0x, v0y) * ::hypot(v1x, v1y)));
 }
 // Curve helpers
-static std::array<double,16> curve_split(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3){
+static inline void curve_split(const double* curve, double* left, double* right){
+	// Curve & output may overlap -> read everything before writing
 #ifdef __SSE2__
-	__m128d split_operand = _mm_set1_pd(0.5),
-		xy0 = _mm_set_pd(y0, x0),
-		xy1 = _mm_set_pd(y1, x1),
-		xy2 = _mm_set_pd(y2, x2),
-		xy3 = _mm_set_pd(y3, x3);
-#ifdef __AVX__
-	__m256d split_operand256 = _mm256_set1_pd(0.5),
-		xy01_12 = _mm256_mul_pd(
-			_mm256_add_pd(
-				_mm256_set_m128d(xy1, xy0),
-				_mm256_set_m128d(xy2, xy1)
-			),
-			split_operand256
-		);
-	__m128d xy01 = _mm256_extractf128_pd(xy01_12, 0x0),
-		xy12 = _mm256_extractf128_pd(xy01_12, 0x1),
+	const __m128d split_operand = _mm_set1_pd(0.5),
+		xy0 = _mm_loadu_pd(curve),
+		xy1 = _mm_loadu_pd(curve+2),
+		xy2 = _mm_loadu_pd(curve+4),
+		xy3 = _mm_loadu_pd(curve+6),
+		xy01 = _mm_mul_pd(_mm_add_pd(xy0, xy1), split_operand),
+		xy12 = _mm_mul_pd(_mm_add_pd(xy1, xy2), split_operand),
+		xy23 = _mm_mul_pd(_mm_add_pd(xy2, xy3), split_operand),
+		xy012 = _mm_mul_pd(_mm_add_pd(xy01, xy12), split_operand),
+		xy123 = _mm_mul_pd(_mm_add_pd(xy12, xy23), split_operand),
+		xy0123 = _mm_mul_pd(_mm_add_pd(xy012, xy123), split_operand);
+	_mm_storeu_pd(left, xy0),
+	_mm_storeu_pd(left+2, xy01),
+	_mm_storeu_pd(left+4, xy012),
+	_mm_storeu_pd(left+6, xy0123),
+	_mm_storeu_pd(right, xy0123),
+	_mm_storeu_pd(right+2, xy123),
+	_mm_storeu_pd(right+4, xy23),
+	_mm_storeu_pd(right+6, xy3);
 #else
-	__m128d xy01 = _mm_mul_pd(
-			_mm_add_pd(
-				xy0,
-				xy1
-			),
-			split_operand
-		),
-		xy12 = _mm_mul_pd(
-			_mm_add_pd(
-				xy1,
-				xy2
-			),
-			split_operand
-		),
-#endif
-		xy23 = _mm_mul_pd(
-			_mm_add_pd(
-				xy2,
-				xy3
-			),
-			split_operand
-		);
-#ifdef __AVX__
-	__m256d xy012_123 = _mm256_mul_pd(
-		_mm256_add_pd(
-			xy01_12,
-			_mm256_set_m128d(xy23, xy12)
-),		),
-		split_operand256
-	);
-	__m128d xy012 = _mm256_extractf128_pd(xy012_123, 0x0),
-		xy123 = _mm256_extractf128_pd(xy012_123, 0x1),
-#else
-	__m128d xy012 = _mm_mul_pd(
-			_mm_add_pd(
-				xy01,
-				xy12
-			),
-			split_operand
-		),
-		xy123 = _mm_mul_pd(
-			_mm_add_pd(
-				xy12,
-				xy23
-			),
-			split_operand
-		),
-#endif
-		xy0123 = _mm_mul_pd(
-			_mm_add_pd(
-				xy012,
-				xy123
-			),
-			split_operand
-		);
-	std::array<double,16> result;
-	_mm_storeu_pd(&result[0], xy0),
-	_mm_storeu_pd(&result[2], xy01),
-	_mm_storeu_pd(&result[4], xy012),
-	_mm_storeu_pd(&result[6], xy0123),
-	_mm_storeu_pd(&result[8], xy0123),
-	_mm_storeu_pd(&result[10], xy123),
-	_mm_storeu_pd(&result[12], xy23),
-	_mm_storeu_pd(&result[14], xy3);
-	return result;
-#else
-	const double x01 = (x0+x1) / 2,
+	const double x0 = curve[0],
+		y0 = curve[1],
+		x1 = curve[2],
+		y1 = curve[3],
+		x2 = curve[4],
+		y2 = curve[5],
+		x3 = curve[6],
+		y3 = curve[7],
+		x01 = (x0+x1) / 2,
 		y01 = (y0+y1) / 2,
 		x12 = (x1+x2) / 2,
 		y12 = (y1+y2) / 2,
@@ -152,8 +98,10 @@ static std::array<double,16> curve_split(double x0, double y0, double x1, double
 		y123 = (y12+y23) / 2,
 		x0123 = (x012+x123) / 2,
 		y0123 = (y012+y123) / 2;
-	return {x0, y0, x01, y01, x012, y012, x0123, y0123,
-		x0123, y0123, x123, y123, x23, y23, x3, y3};
+	left[0] = x0, left[1] = y0, left[2] = x01, left[3] = y01,
+	left[4] = x012, left[5] = y012, left[6] = x0123, left[7] = y0123,
+	right[0] = x0123, right[1] = y0123, right[2] = x123, right[3] = y123,
+	right[4] = x23, right[5] = y23, right[6] = x3, right[7] = y3;
 #endif
 }
 static bool curve_is_flat(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3, double tolerance_angle){
@@ -184,21 +132,71 @@ static bool curve_is_flat(double x0, double y0, double x1, double y1, double x2,
 	}
 	return true;
 }
-static std::vector<double> curve_to_lines(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3, double tolerance_angle){
-	std::vector<double> lines{x0, y0};
-	std::function<void(double,double,double,double,double,double,double,double)> generator =
-	[&lines,&generator,&tolerance_angle](double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3){
-		if(curve_is_flat(x0, y0, x1, y1, x2, y2, x3, y3, tolerance_angle))
-			lines.push_back(x3),
-			lines.push_back(y3);
+// Array helpers
+static void array_min_max(const double* data, size_t n, double& min, double& max){
+	size_t i = 1;
+	min = max = data[0];
+#ifdef __AVX__
+	if(n >= 4){
+		__m256d m_min = _mm256_loadu_pd(data),
+			m_max = m_min;
+		for(i = 4; i + 4 <= n; i += 4){
+			const __m256d m_data = _mm256_loadu_pd(data+i);
+			m_min = _mm256_min_pd(m_min, m_data),
+			m_max = _mm256_max_pd(m_max, m_data);
+		}
+		const __m128d m_min2 = _mm_min_pd(_mm256_extractf128_pd(m_min, 0x0), _mm256_extractf128_pd(m_min, 0x1)),
+			m_max2 = _mm_max_pd(_mm256_extractf128_pd(m_max, 0x0), _mm256_extractf128_pd(m_max, 0x1));
+		min = std::min(_mm_cvtsd_f64(m_min2), _mm_cvtsd_f64(_mm_unpackhi_pd(m_min2, m_min2))),
+		max = std::max(_mm_cvtsd_f64(m_max2), _mm_cvtsd_f64(_mm_unpackhi_pd(m_max2, m_max2)));
+	}
+#elif defined __SSE2__
+	if(n >= 2){
+		__m128d m_min = _mm_loadu_pd(data),
+			m_max = m_min;
+		for(i = 2; i + 2 <= n; i += 2){
+			const __m128d m_data = _mm_loadu_pd(data+i);
+			m_min = _mm_min_pd(m_min, m_data),
+			m_max = _mm_max_pd(m_max, m_data);
+		}
+		min = std::min(_mm_cvtsd_f64(m_min), _mm_cvtsd_f64(_mm_unpackhi_pd(m_min, m_min))),
+		max = std::max(_mm_cvtsd_f64(m_max), _mm_cvtsd_f64(_mm_unpackhi_pd(m_max, m_max)));
+	}
+#endif
+	for(; i < n; ++i)
+		if(data[i] < min)
+			min = data[i];
+		else if(data[i] > max)
+			max = data[i];
+}
+// Maximal curve subdivisions (splits beyond are numerically meaningless)
+static constexpr unsigned curve_max_depth = 32;
+static size_t curve_lines_estimate(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3, double tolerance_angle){
+	// Turning of control polygon divided by tolerance (lines of subdivision have at most tolerance angle between them)
+	const double turn = angle_vec_x_vec(x1 - x0, y1 - y0, x2 - x1, y2 - y1) + angle_vec_x_vec(x2 - x1, y2 - y1, x3 - x2, y3 - y2);
+	return tolerance_angle > 0 ? std::min(static_cast<size_t>(turn / tolerance_angle) + 1, static_cast<size_t>(1024)) : 1;
+}
+template<typename Output>
+static void curve_to_lines(double x0, double y0, double x1, double y1, double x2, double y2, double x3, double y3, double tolerance_angle, Output output){
+	// Stack of curves to process (left halves on top) & their depths
+	double stack[(curve_max_depth+1) * 8];
+	unsigned char depths[curve_max_depth+1];
+	stack[0] = x0, stack[1] = y0, stack[2] = x1, stack[3] = y1,
+	stack[4] = x2, stack[5] = y2, stack[6] = x3, stack[7] = y3,
+	depths[0] = 0;
+	unsigned top = 0;
+	do{
+		double* const curve = stack + top * 8;
+		const unsigned char depth = depths[top];
+		if(depth == curve_max_depth || curve_is_flat(curve[0], curve[1], curve[2], curve[3], curve[4], curve[5], curve[6], curve[7], tolerance_angle))
+			output(curve[6], curve[7]);
 		else{
-			auto curves = curve_split(x0, y0, x1, y1, x2, y2, x3, y3);
-			generator(curves[0], curves[1], curves[2], curves[3], curves[4], curves[5], curves[6], curves[7]),
-			generator(curves[8], curves[9], curves[10], curves[11], curves[12], curves[13], curves[14], curves[15]);
+			// Replace curve by right half & push left half
+			curve_split(curve, curve + 8, curve),
+			depths[top] = depths[top+1] = depth + 1,
+			top += 2;
 		}
-	};
-	generator(x0, y0, x1, y1, x2, y2, x3, y3);
-	return lines;
+	}while(top-- > 0);
 }
 
 namespace GUtils{
@@ -245,42 +243,140 @@ namespace GUtils{
 		return path;
 	}
 	std::vector<PathSegment>& path_flatten(std::vector<PathSegment>& path, double tolerance){
+		// Curve with start point at given position?
+		auto is_curve = [&path](size_t i){
+			return i > 0 &&
+				path[i-1].type != PathSegment::Type::CLOSE &&
+				i+2 < path.size() &&
+				path[i].type == PathSegment::Type::CURVE &&
+				path[i+1].type == PathSegment::Type::CURVE &&
+				path[i+2].type == PathSegment::Type::CURVE;
+		};
+		// Estimate size of new path
+		size_t new_size = 0;
+		for(size_t i = 0; i < path.size(); ++i)
+			if(path[i].type != PathSegment::Type::CURVE)
+				++new_size;
+			else if(is_curve(i))
+				new_size += curve_lines_estimate(path[i-1].x, path[i-1].y, path[i].x, path[i].y, path[i+1].x, path[i+1].y, path[i+2].x, path[i+2].y, tolerance),
+				i += 2;
 		// Buffer for new path
 		std::vector<PathSegment> new_path;
-		new_path.reserve(path.size());
+		new_path.reserve(new_size);
 		// Go through path segments
-		for(auto seg_iter = path.begin(); seg_iter != path.end(); ++seg_iter)
+		for(size_t i = 0; i < path.size(); ++i)
 			// Sort curves out
-			if(seg_iter->type == PathSegment::Type::CURVE){
+			if(path[i].type == PathSegment::Type::CURVE){
 				// Enough segments for curve flattening?
-				if(seg_iter != path.begin() &&
-					(seg_iter-1)->type != PathSegment::Type::CLOSE &&
-					seg_iter+2 < path.end() &&
-					(seg_iter+1)->type == PathSegment::Type::CURVE &&
-					(seg_iter+2)->type == PathSegment::Type::CURVE
-				){
-					// Convert curve to lines and add to new path
-					PathSegment& s0 = *(seg_iter-1),
-						&s1 = *seg_iter,
-						&s2 = *(seg_iter+1),
-						&s3 = *(seg_iter+2);
-					auto lines = curve_to_lines(s0.x, s0.y, s1.x, s1.y, s2.x, s2.y, s3.x, s3.y, tolerance);
-					for(auto lines_iter = lines.begin()+2; lines_iter < lines.end(); lines_iter+=2)
-						new_path.push_back({PathSegment::Type::LINE, *lines_iter, *(lines_iter+1)});
+				if(is_curve(i)){
+					// Convert curve to lines directly into new path
+					const PathSegment& s0 = path[i-1],
+						&s1 = path[i],
+						&s2 = path[i+1],
+						&s3 = path[i+2];
+					curve_to_lines(s0.x, s0.y, s1.x, s1.y, s2.x, s2.y, s3.x, s3.y, tolerance, [&new_path](double x, double y){
+						new_path.push_back({PathSegment::Type::LINE, x, y});
+					});
 					// Discard used curve segments
-					seg_iter += 2;
+					i += 2;
 				}
 			// Non-curves just get copied
 			}else
-				new_path.push_back(*seg_iter);
+				new_path.push_back(path[i]);
 		// Transfer new path data to old path
 		path = std::move(new_path);
 		return path;
 	}
 	std::vector<PathSegment>& path_transform(std::vector<PathSegment>& path, Matrix4x4d& mat){
-		for(auto& segment : path)
-			if(segment.type != PathSegment::Type::CLOSE)
-				mat.transform2d(&segment.x);
+		// Transform runs of points at once
+		for(auto seg_iter = path.begin(); seg_iter != path.end();){
+			auto run_end = std::find_if(seg_iter, path.end(), [](const PathSegment& segment){return segment.type == PathSegment::Type::CLOSE;});
+			if(run_end != seg_iter)
+				mat.transform2d(&seg_iter->x, run_end - seg_iter, sizeof(PathSegment));
+			seg_iter = run_end == path.end() ? run_end : run_end + 1;
+		}
+		return path;
+	}
+	Path::Path(const std::vector<PathSegment>& segments){
+		this->reserve(segments.size());
+		for(const PathSegment& segment : segments)
+			if(segment.type == PathSegment::Type::CLOSE)
+				this->close();
+			else
+				this->push_back(segment.type, segment.x, segment.y);
+	}
+	std::vector<PathSegment> Path::segments() const{
+		std::vector<PathSegment> segments(this->types.size());
+		for(size_t i = 0; i < segments.size(); ++i)
+			segments[i] = {this->types[i], this->xs[i], this->ys[i]};
+		return segments;
+	}
+	bool path_extents(const Path& path, double* x0, double* y0, double* x1, double* y1){
+		// Skip closes without previous point
+		const PathSegment::Type* const types = path.type_data();
+		size_t first = 0;
+		while(first < path.size() && types[first] == PathSegment::Type::CLOSE)
+			++first;
+		if(first == path.size())
+			return false;
+		// Find extreme points in coordinate arrays
+		double temp_x0, temp_y0, temp_x1, temp_y1;
+		array_min_max(path.x_data() + first, path.size() - first, temp_x0, temp_x1),
+		array_min_max(path.y_data() + first, path.size() - first, temp_y0, temp_y1);
+		// Assign result to output
+		if(x0) *x0 = temp_x0;
+		if(y0) *y0 = temp_y0;
+		if(x1) *x1 = temp_x1;
+		if(y1) *y1 = temp_y1;
+		return true;
+	}
+	Path& path_flatten(Path& path, double tolerance){
+		const PathSegment::Type* const types = path.type_data();
+		const double* const xs = path.x_data(),
+			*const ys = path.y_data();
+		const size_t n = path.size();
+		// Curve with start point at given position?
+		auto is_curve = [types,n](size_t i){
+			return i > 0 &&
+				types[i-1] != PathSegment::Type::CLOSE &&
+				i+2 < n &&
+				types[i] == PathSegment::Type::CURVE &&
+				types[i+1] == PathSegment::Type::CURVE &&
+				types[i+2] == PathSegment::Type::CURVE;
+		};
+		// Estimate size of new path
+		size_t new_size = 0;
+		for(size_t i = 0; i < n; ++i)
+			if(types[i] != PathSegment::Type::CURVE)
+				++new_size;
+			else if(is_curve(i))
+				new_size += curve_lines_estimate(xs[i-1], ys[i-1], xs[i], ys[i], xs[i+1], ys[i+1], xs[i+2], ys[i+2], tolerance),
+				i += 2;
+		// Buffer for new path
+		Path new_path;
+		new_path.reserve(new_size);
+		// Go through path segments
+		for(size_t i = 0; i < n; ++i)
+			switch(types[i]){
+				case PathSegment::Type::MOVE:
+				case PathSegment::Type::LINE: new_path.push_back(types[i], xs[i], ys[i]); break;
+				case PathSegment::Type::CURVE:
+					// Convert curve to lines directly into new path & discard used curve segments
+					if(is_curve(i))
+						curve_to_lines(xs[i-1], ys[i-1], xs[i], ys[i], xs[i+1], ys[i+1], xs[i+2], ys[i+2], tolerance, [&new_path](double x, double y){
+							new_path.push_back(PathSegment::Type::LINE, x, y);
+						}),
+						i += 2;
+					break;
+				case PathSegment::Type::CLOSE: new_path.close(); break;
+			}
+		// Transfer new path data to old path
+		path = std::move(new_path);
+		return path;
+	}
+	Path& path_transform(Path& path, Matrix4x4d& mat){
+		// Closes repeat previous points, so transform all at once
+		mat.transform2d(path.x_data(), path.y_data(), path.size());
 		return path;
 	}
 	std::vector<PathSegment> path_by_arc(double x, double y, double cx, double cy, double angle){
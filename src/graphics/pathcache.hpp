@@ -0,0 +1,84 @@
+/*
+Project: SSBRenderer
+File: pathcache.hpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include "gutils.hpp"
+#include "../utils/memory.hpp"
+#include <memory>
+#include <mutex>
+#include <cstring>
+
+namespace GUtils{
+	// Mix value into hash
+	inline void hash_combine(size_t& seed, size_t value){
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	// Paths computed from path & parameters, cached by path content (equal shapes share entries) within memory budget, thread-safe
+	template<typename Params, typename ParamsHash = std::hash<Params>>
+	class PathCache{
+		public:
+			using Result = std::shared_ptr<const std::vector<PathSegment>>;
+		private:
+			// Lookups reference path, entries own a copy
+			struct Key{
+				const std::vector<PathSegment>* path;
+				std::shared_ptr<const std::vector<PathSegment>> path_copy;
+				Params params;
+				size_t hash;
+				bool operator==(const Key& other) const{
+					return this->hash == other.hash && this->params == other.params &&
+						this->path->size() == other.path->size() &&
+						std::equal(this->path->begin(), this->path->end(), other.path->begin(), [](const PathSegment& a, const PathSegment& b){
+							return a.type == b.type && std::memcmp(&a.x, &b.x, sizeof(a.x)) == 0 && std::memcmp(&a.y, &b.y, sizeof(a.y)) == 0;	// Bitwise, so NaNs find themselves
+						});
+				}
+			};
+			struct KeyHash{
+				size_t operator()(const Key& key) const{return key.hash;}
+			};
+			stdex::SizedCache<Key, Result, KeyHash> cache;
+			std::mutex mutex;	// Lock for cache access only, computations run in parallel
+		public:
+			explicit PathCache(size_t budget) : cache(budget){}
+			// Cached result or new one by compute(path, params)
+			template<typename Compute>
+			Result get(const std::vector<PathSegment>& path, const Params& params, Compute compute){
+				// Parameters not equal to themselves (NaN) would never be found again
+				if(!(params == params))
+					return std::make_shared<const std::vector<PathSegment>>(compute(path, params));
+				// Build key
+				Key key{&path, nullptr, params, ParamsHash()(params)};
+				for(const PathSegment& segment : path)
+					hash_combine(key.hash, static_cast<size_t>(segment.type)),
+					hash_combine(key.hash, std::hash<double>()(segment.x)),
+					hash_combine(key.hash, std::hash<double>()(segment.y));
+				// Reuse result
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					Result result = this->cache.get(key);
+					if(result)
+						return result;
+				}
+				// Compute & store new result
+				Result result = std::make_shared<const std::vector<PathSegment>>(compute(path, params));
+				key.path_copy = std::make_shared<const std::vector<PathSegment>>(path),
+				key.path = key.path_copy.get();
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->cache.add(key, result, (path.size() + result->size()) * sizeof(PathSegment) + sizeof(Key));
+				return result;
+			}
+	};
+}
@@ -0,0 +1,258 @@
+/*
+Project: SSBRenderer
+File: raster.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "gutils.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "simd.h"
+
+// Accumulate signed area covered left of line into cells (rows of row_size cells, 2 more than pixels)
+static void accumulate_line(float* cells, const unsigned row_size, const unsigned height, float x0, float y0, float x1, float y1){
+	// Horizontal lines don't cover anything
+	if(y0 == y1)
+		return;
+	// Lines downwards with direction sign
+	float dir = 1;
+	if(y0 > y1)
+		std::swap(x0, x1),
+		std::swap(y0, y1),
+		dir = -1;
+	const float dxdy = (x1 - x0) / (y1 - y0);
+	float x = x0;
+	// Go through touched rows
+	for(unsigned y = static_cast<unsigned>(y0), y_end = std::min(height, static_cast<unsigned>(std::ceil(y1))); y < y_end; ++y){
+		float* const row = cells + y * row_size;
+		const float dy = std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0),
+			x_next = x + dxdy * dy,
+			d = dy * dir,
+			x_left = std::min(x, x_next),
+			x_right = std::max(x, x_next),
+			x_left_floor = std::floor(x_left),
+			x_right_ceil = std::ceil(x_right);
+		const int x_left_i = static_cast<int>(x_left_floor),
+			x_right_i = static_cast<int>(x_right_ceil);
+		// Line inside one pixel: split area by line mid
+		if(x_right_i <= x_left_i + 1){
+			const float x_mid = 0.5f * (x + x_next) - x_left_floor;
+			row[x_left_i] += d - d * x_mid,
+			row[x_left_i+1] += d * x_mid;
+		// Line over many pixels: triangle areas at ends, linear ramp between
+		}else{
+			const float s = 1 / (x_right - x_left),
+				x_left_fract = x_left - x_left_floor,
+				a0 = 0.5f * s * (1 - x_left_fract) * (1 - x_left_fract),
+				x_right_fract = x_right - x_right_ceil + 1,
+				am = 0.5f * s * x_right_fract * x_right_fract;
+			row[x_left_i] += d * a0;
+			if(x_right_i == x_left_i + 2)
+				row[x_left_i+1] += d * (1 - a0 - am);
+			else{
+				const float a1 = s * (1.5f - x_left_fract);
+				row[x_left_i+1] += d * (a1 - a0);
+				for(int xi = x_left_i + 2; xi < x_right_i - 1; ++xi)
+					row[xi] += d * s;
+				const float a2 = a1 + (x_right_i - x_left_i - 3) * s;
+				row[x_right_i-1] += d * (1 - a2 - am);
+			}
+			row[x_right_i] += d * am;
+		}
+		x = x_next;
+	}
+}
+
+// Sum cells up to coverage of row pixels & convert by fill rule to 8-bit
+static void accumulate_row(const float* row, unsigned char* mask, const unsigned width, const GUtils::FillRule rule){
+	unsigned x = 0;
+	float sum = 0;
+#ifdef __SSE2__
+	const __m128 sign_mask = _mm_set1_ps(-0.0f),
+		one = _mm_set1_ps(1),
+		half = _mm_set1_ps(0.5f),
+		two = _mm_set1_ps(2),
+		max_value = _mm_set1_ps(255);
+	__m128 carry = _mm_setzero_ps();
+	for(; x + 4 <= width; x += 4){
+		// Prefix sum of 4 cells + sum of previous cells
+		__m128 cover = _mm_load_ps(row + x);
+		cover = _mm_add_ps(cover, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(cover), 4))),
+		cover = _mm_add_ps(cover, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(cover), 8))),
+		cover = _mm_add_ps(cover, carry),
+		carry = _mm_shuffle_ps(cover, cover, _MM_SHUFFLE(3,3,3,3));
+		// Winding to coverage
+		cover = _mm_andnot_ps(sign_mask, cover);
+		if(rule == GUtils::FillRule::NONZERO)
+			cover = _mm_min_ps(cover, one);
+		else{
+			// Fold into [0,2) & mirror to [0,1]
+			cover = _mm_sub_ps(cover, _mm_mul_ps(two, _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(cover, half))))),
+			cover = _mm_sub_ps(one, _mm_andnot_ps(sign_mask, _mm_sub_ps(cover, one)));
+		}
+		// Store as bytes
+		const __m128i cover_i = _mm_cvtps_epi32(_mm_mul_ps(cover, max_value)),
+			cover_i16 = _mm_packs_epi32(cover_i, cover_i);
+		const int cover_bytes = _mm_cvtsi128_si32(_mm_packus_epi16(cover_i16, cover_i16));
+		std::memcpy(mask + x, &cover_bytes, sizeof(cover_bytes));	// Mask rows aren't aligned
+	}
+	sum = _mm_cvtss_f32(carry);
+#endif
+	for(; x < width; ++x){
+		sum += row[x];
+		float cover = std::abs(sum);
+		if(rule == GUtils::FillRule::NONZERO)
+			cover = std::min(cover, 1.0f);
+		else
+			cover -= 2 * static_cast<int>(cover * 0.5f),
+			cover = 1 - std::abs(cover - 1);
+		mask[x] = static_cast<unsigned char>(cover * 255 + 0.5f);
+	}
+}
+
+// Accumulate line clipped to cells area (parts above & below don't cover rows, parts left & right cover border cells like vertical lines)
+static void accumulate_clipped_line(float* cells, const unsigned row_size, const unsigned width, const unsigned height, double x0, double y0, double x1, double y1){
+	// Vertical clipping (downwards, direction kept for pieces)
+	const bool upwards = y0 > y1;
+	if(upwards)
+		std::swap(x0, x1),
+		std::swap(y0, y1);
+	if(y1 <= 0 || y0 >= height || y0 == y1)
+		return;
+	const double dxdy = (x1 - x0) / (y1 - y0);
+	if(y0 < 0)
+		x0 -= dxdy * y0,
+		y0 = 0;
+	if(y1 > height)
+		x1 -= dxdy * (y1 - height),
+		y1 = height;
+	// Horizontal splitting at borders & clamping
+	double xs[4] = {x0}, ys[4] = {y0};
+	unsigned n = 1;
+	for(const double border : {0.0, static_cast<double>(width)})
+		if((x0 < border) != (x1 < border) && x0 != border && x1 != border)
+			xs[n] = border,
+			ys[n++] = y0 + (border - x0) / dxdy;
+	if(n == 3 && (ys[1] > ys[2]))
+		std::swap(xs[1], xs[2]),
+		std::swap(ys[1], ys[2]);
+	xs[n] = x1,
+	ys[n] = y1;
+	for(unsigned i = 0; i < n; ++i){
+		const unsigned from = upwards ? i + 1 : i, to = upwards ? i : i + 1;
+		accumulate_line(cells, row_size, height,
+				static_cast<float>(std::min(std::max(xs[from], 0.0), static_cast<double>(width))), static_cast<float>(ys[from]),
+				static_cast<float>(std::min(std::max(xs[to], 0.0), static_cast<double>(width))), static_cast<float>(ys[to]));
+	}
+}
+
+// Rasterize segments (got by index) in bounding box limited to clip box
+template<typename Segment>
+static GUtils::Image2D<> rasterize(const size_t n, Segment segment, double x0, double y0, double x1, double y1,
+				double clip_x0, double clip_y0, double clip_x1, double clip_y1, const GUtils::FillRule rule, int& mask_x, int& mask_y){
+	// Invalid (NaN/infinite) or huge coordinates aren't rasterizable
+	static constexpr double coord_limit = 1 << 30;
+	if(!(x0 >= -coord_limit && y0 >= -coord_limit && x1 <= coord_limit && y1 <= coord_limit))
+		return mask_x = mask_y = 0, GUtils::Image2D<>();
+	// Pixel-aligned bounding box in clip box
+	const double origin_x = std::max(std::floor(x0), clip_x0),
+		origin_y = std::max(std::floor(y0), clip_y0),
+		end_x = std::min(std::ceil(x1), clip_x1),
+		end_y = std::min(std::ceil(y1), clip_y1);
+	if(!(origin_x < end_x && origin_y < end_y))
+		return mask_x = mask_y = 0, GUtils::Image2D<>();
+	const unsigned width = static_cast<unsigned>(end_x - origin_x),
+		height = static_cast<unsigned>(end_y - origin_y),
+		row_size = (width + 2 + 3) & ~3u;	// Cells for line ends beyond right border, rounded up for aligned loads
+	// Cells & mask have to be addressable
+	if(static_cast<unsigned long long>(row_size) * height > std::numeric_limits<unsigned>::max() ||
+		static_cast<unsigned long long>(row_size) * height > std::numeric_limits<size_t>::max() / sizeof(float))
+		return mask_x = mask_y = 0, GUtils::Image2D<>();
+	mask_x = static_cast<int>(origin_x),
+	mask_y = static_cast<int>(origin_y);
+	// Accumulate lines of contours (closed implicitly)
+	std::vector<float, GUtils::AlignedAllocator<float>> cells(static_cast<size_t>(row_size) * height);
+	double start_x = 0, start_y = 0, last_x = 0, last_y = 0;
+	bool open = false;
+	for(size_t i = 0; i < n; ++i){
+		GUtils::PathSegment::Type type;
+		double x, y;
+		segment(i, type, x, y);
+		x -= origin_x,
+		y -= origin_y;
+		switch(type){
+			case GUtils::PathSegment::Type::MOVE:
+				if(open)
+					accumulate_clipped_line(cells.data(), row_size, width, height, last_x, last_y, start_x, start_y);
+				start_x = last_x = x,
+				start_y = last_y = y,
+				open = true;
+				break;
+			case GUtils::PathSegment::Type::LINE:
+			case GUtils::PathSegment::Type::CURVE:
+				if(open)
+					accumulate_clipped_line(cells.data(), row_size, width, height, last_x, last_y, x, y);
+				else
+					start_x = x,
+					start_y = y,
+					open = true;
+				last_x = x,
+				last_y = y;
+				break;
+			case GUtils::PathSegment::Type::CLOSE:
+				if(open)
+					accumulate_clipped_line(cells.data(), row_size, width, height, last_x, last_y, start_x, start_y),
+					last_x = start_x,
+					last_y = start_y;
+				break;
+		}
+	}
+	if(open)
+		accumulate_clipped_line(cells.data(), row_size, width, height, last_x, last_y, start_x, start_y);
+	// Convert cells to mask
+	GUtils::Image2D<> mask(width, height, width);
+	for(unsigned y = 0; y < height; ++y)
+		accumulate_row(cells.data() + static_cast<size_t>(y) * row_size, mask.get_data() + static_cast<size_t>(y) * width, width, rule);
+	return mask;
+}
+
+namespace GUtils{
+	Image2D<> path_rasterize(const std::vector<PathSegment>& path, FillRule rule, int& mask_x, int& mask_y){
+		return path_rasterize(path, rule, std::numeric_limits<int>::min(), std::numeric_limits<int>::min(), std::numeric_limits<unsigned>::max(), std::numeric_limits<unsigned>::max(), mask_x, mask_y);
+	}
+	Image2D<> path_rasterize(const std::vector<PathSegment>& path, FillRule rule, int clip_x, int clip_y, unsigned clip_width, unsigned clip_height, int& mask_x, int& mask_y){
+		double x0, y0, x1, y1;
+		if(!path_extents(path, &x0, &y0, &x1, &y1))
+			return mask_x = mask_y = 0, Image2D<>();
+		return rasterize(path.size(), [&path](size_t i, PathSegment::Type& type, double& x, double& y){
+			type = path[i].type,
+			x = path[i].x,
+			y = path[i].y;
+		}, x0, y0, x1, y1, clip_x, clip_y, static_cast<double>(clip_x) + clip_width, static_cast<double>(clip_y) + clip_height, rule, mask_x, mask_y);
+	}
+	Image2D<> path_rasterize(const Path& path, FillRule rule, int& mask_x, int& mask_y){
+		return path_rasterize(path, rule, std::numeric_limits<int>::min(), std::numeric_limits<int>::min(), std::numeric_limits<unsigned>::max(), std::numeric_limits<unsigned>::max(), mask_x, mask_y);
+	}
+	Image2D<> path_rasterize(const Path& path, FillRule rule, int clip_x, int clip_y, unsigned clip_width, unsigned clip_height, int& mask_x, int& mask_y){
+		double x0, y0, x1, y1;
+		if(!path_extents(path, &x0, &y0, &x1, &y1))
+			return mask_x = mask_y = 0, Image2D<>();
+		const PathSegment::Type* const types = path.type_data();
+		const double* const xs = path.x_data(),
+			*const ys = path.y_data();
+		return rasterize(path.size(), [types,xs,ys](size_t i, PathSegment::Type& type, double& x, double& y){
+			type = types[i],
+			x = xs[i],
+			y = ys[i];
+		}, x0, y0, x1, y1, clip_x, clip_y, static_cast<double>(clip_x) + clip_width, static_cast<double>(clip_y) + clip_height, rule, mask_x, mask_y);
+	}
+}
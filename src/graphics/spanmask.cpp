@@ -0,0 +1,146 @@
+/*
+Project: SSBRenderer
+File: spanmask.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "gutils.hpp"
+#include <algorithm>
+
+// Append coverage run to row (merged with equal neighbour, uncovered dropped)
+static inline void push_span(std::vector<GUtils::SpanMask::Span>& row, int x0, int x1, unsigned char coverage){
+	if(!coverage || x0 >= x1)
+		return;
+	if(!row.empty() && row.back().x1 == x0 && row.back().coverage == coverage)
+		row.back().x1 = x1;
+	else
+		row.push_back({x0, x1, coverage});
+}
+
+// Coverage products rounded to 8 bit
+static inline unsigned char mul_coverage(unsigned a, unsigned b){
+	return (a * b + 127) / 255;
+}
+
+namespace GUtils{
+	template<typename Op>
+	void SpanMask::combine(const Image2D<>& mask, int mask_x, int mask_y, Op op){
+		const int width = mask.get_width(), height = mask.get_height();
+		if(width <= 0 || height <= 0)
+			return;
+		// Extend rows to mask
+		if(this->rows.empty())
+			this->row_first = mask_y,
+			this->rows.resize(height);
+		else{
+			if(mask_y < this->row_first)
+				this->rows.insert(this->rows.begin(), this->row_first - mask_y, {}),
+				this->row_first = mask_y;
+			if(mask_y + height > this->row_first + static_cast<int>(this->rows.size()))
+				this->rows.resize(mask_y + height - this->row_first);
+		}
+		// Merge mask rows into span rows
+		std::vector<Span> new_row;
+		for(int y = 0; y < height; ++y){
+			std::vector<Span>& row = this->rows[mask_y + y - this->row_first];
+			const unsigned char* mask_row = mask.get_data() + y * mask.get_stride();
+			new_row.clear();
+			auto span = row.begin();
+			// Spans before mask
+			for(; span != row.end() && span->x1 <= mask_x; ++span)
+				new_row.push_back(*span);
+			if(span != row.end() && span->x0 < mask_x)
+				new_row.push_back({span->x0, mask_x, span->coverage});
+			// Mask area (runs of equal result)
+			int run_x = mask_x;
+			unsigned char run_coverage = 0;
+			for(int x = mask_x, x_end = mask_x + width; x < x_end; ++x){
+				while(span != row.end() && span->x1 <= x)
+					++span;
+				const unsigned char coverage = op(span != row.end() && span->x0 <= x ? span->coverage : 0, mask_row[x - mask_x]);
+				if(coverage != run_coverage)
+					push_span(new_row, run_x, x, run_coverage),
+					run_x = x,
+					run_coverage = coverage;
+			}
+			push_span(new_row, run_x, mask_x + width, run_coverage);
+			// Spans after mask
+			for(; span != row.end(); ++span)
+				push_span(new_row, std::max(span->x0, mask_x + width), span->x1, span->coverage);
+			row.swap(new_row);
+		}
+		// Drop uncovered rows at borders
+		auto first = std::find_if(this->rows.begin(), this->rows.end(), [](const std::vector<Span>& row){return !row.empty();});
+		if(first == this->rows.end())
+			this->clear();
+		else{
+			auto last = std::find_if(this->rows.rbegin(), this->rows.rend(), [](const std::vector<Span>& row){return !row.empty();}).base();
+			this->rows.erase(last, this->rows.end()),
+			this->row_first += first - this->rows.begin(),
+			this->rows.erase(this->rows.begin(), first);
+		}
+	}
+
+	void SpanMask::unite(const Image2D<>& mask, int mask_x, int mask_y){
+		this->combine(mask, mask_x, mask_y, [](unsigned char coverage, unsigned char mask_coverage){
+			return static_cast<unsigned char>(coverage + mul_coverage(255 - coverage, mask_coverage));
+		});
+	}
+
+	void SpanMask::subtract(const Image2D<>& mask, int mask_x, int mask_y){
+		this->combine(mask, mask_x, mask_y, [](unsigned char coverage, unsigned char mask_coverage){
+			return mul_coverage(coverage, 255 - mask_coverage);
+		});
+	}
+
+	void SpanMask::clip(Image2D<>& mask, int mask_x, int mask_y, bool inside) const{
+		const int width = mask.get_width(), height = mask.get_height();
+		for(int y = 0; y < height; ++y){
+			unsigned char* mask_row = mask.get_data() + y * mask.get_stride();
+			const int row_i = mask_y + y - this->row_first;
+			// Uncovered row
+			if(row_i < 0 || row_i >= static_cast<int>(this->rows.size())){
+				if(inside)
+					std::fill(mask_row, mask_row + width, 0);
+				continue;
+			}
+			// Scale mask by span coverage, gaps by uncovered
+			int x = mask_x;
+			const int x_end = mask_x + width;
+			for(const Span& span : this->rows[row_i]){
+				if(span.x1 <= x)
+					continue;
+				if(span.x0 >= x_end)
+					break;
+				if(inside)
+					std::fill(mask_row + (x - mask_x), mask_row + (std::max(span.x0, x) - mask_x), 0);
+				x = std::max(span.x0, x);
+				const int span_end = std::min(span.x1, x_end);
+				const unsigned char factor = inside ? span.coverage : 255 - span.coverage;
+				if(factor != 255)
+					for(unsigned char* pmask = mask_row + (x - mask_x), * const pmask_end = mask_row + (span_end - mask_x); pmask != pmask_end; ++pmask)
+						*pmask = mul_coverage(*pmask, factor);
+				x = span_end;
+			}
+			if(inside)
+				std::fill(mask_row + (x - mask_x), mask_row + width, 0);
+		}
+	}
+
+	unsigned char SpanMask::get(int x, int y) const{
+		const int row_i = y - this->row_first;
+		if(row_i < 0 || row_i >= static_cast<int>(this->rows.size()))
+			return 0;
+		const std::vector<Span>& row = this->rows[row_i];
+		auto span = std::upper_bound(row.begin(), row.end(), x, [](int x, const Span& span){return x < span.x1;});
+		return span != row.end() && span->x0 <= x ? span->coverage : 0;
+	}
+}
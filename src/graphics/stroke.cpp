@@ -0,0 +1,309 @@
+/*
+Project: SSBRenderer
+File: stroke.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "gutils.hpp"
+#include "pathcache.hpp"
+#include <config.h>
+#include <cmath>
+
+// Point helpers
+struct StrokePoint{
+	double x, y;
+};
+static inline bool point_equal(const StrokePoint& p0, const StrokePoint& p1){
+	return p0.x == p1.x && p0.y == p1.y;
+}
+// Maximal distance of round join/cap polygons to real circle
+static constexpr double stroke_tolerance = 0.01;
+// Miter length to line width ratio before falling back to bevel (like cairo)
+static constexpr double stroke_miter_limit = 10;
+
+// Line style & dashes as stroke cache parameters
+struct StrokeParams{
+	double width;
+	GUtils::LineJoin join;
+	GUtils::LineCap cap;
+	double dash_offset;
+	std::vector<double> dashes;
+	bool operator==(const StrokeParams& other) const{
+		return this->width == other.width && this->join == other.join && this->cap == other.cap &&
+			this->dash_offset == other.dash_offset && this->dashes == other.dashes;
+	}
+};
+struct StrokeParamsHash{
+	size_t operator()(const StrokeParams& params) const{
+		size_t hash = std::hash<double>()(params.width);
+		GUtils::hash_combine(hash, static_cast<size_t>(params.join)),
+		GUtils::hash_combine(hash, static_cast<size_t>(params.cap)),
+		GUtils::hash_combine(hash, std::hash<double>()(params.dash_offset));
+		for(double dash : params.dashes)
+			GUtils::hash_combine(hash, std::hash<double>()(dash));
+		return hash;
+	}
+};
+
+// Stroke outline output as same-oriented polygons (union by nonzero fill)
+class StrokeOutline{
+	private:
+		std::vector<GUtils::PathSegment>& path;
+		const double half_width, arc_step;
+	public:
+		StrokeOutline(std::vector<GUtils::PathSegment>& path, double half_width)
+		: path(path), half_width(half_width), arc_step(half_width > stroke_tolerance ? 2 * std::acos(1 - stroke_tolerance / half_width) : M_PI_2){}
+		// Add polygon, orientation turned negative
+		void polygon(const StrokePoint* points, const size_t n){
+			double area = 0;
+			for(size_t i = 0, j = n - 1; i < n; j = i++)
+				area += points[j].x * points[i].y - points[i].x * points[j].y;
+			if(area == 0)
+				return;
+			this->path.push_back({GUtils::PathSegment::Type::MOVE, points[0].x, points[0].y});
+			if(area < 0)
+				for(size_t i = 1; i < n; ++i)
+					this->path.push_back({GUtils::PathSegment::Type::LINE, points[i].x, points[i].y});
+			else
+				for(size_t i = n - 1; i > 0; --i)
+					this->path.push_back({GUtils::PathSegment::Type::LINE, points[i].x, points[i].y});
+			this->path.push_back({GUtils::PathSegment::Type::CLOSE, points[0].x, points[0].y});
+		}
+		// Line body
+		void segment(const StrokePoint& p0, const StrokePoint& p1, double nx, double ny){
+			const StrokePoint quad[] = {{p0.x + nx, p0.y + ny}, {p1.x + nx, p1.y + ny}, {p1.x - nx, p1.y - ny}, {p0.x - nx, p0.y - ny}};
+			this->polygon(quad, 4);
+		}
+		// Arc from offset (x,y) around center by angle as pie
+		void pie(const StrokePoint& center, double x, double y, double angle){
+			const unsigned steps = std::max(1u, static_cast<unsigned>(std::ceil(std::abs(angle) / this->arc_step)));
+			const double step_sin = std::sin(angle / steps),
+				step_cos = std::cos(angle / steps);
+			std::vector<StrokePoint> points{center, {center.x + x, center.y + y}};
+			points.reserve(steps + 2);
+			for(unsigned i = 0; i < steps; ++i){
+				const double temp_x = x;
+				x = step_cos * x - step_sin * y,
+				y = step_sin * temp_x + step_cos * y,
+				points.push_back({center.x + x, center.y + y});
+			}
+			this->polygon(points.data(), points.size());
+		}
+		void circle(const StrokePoint& center){
+			this->pie(center, this->half_width, 0, 2 * M_PI);
+		}
+		// Connection of lines with normals n0 & n1 at point
+		void join(const StrokePoint& p, double n0x, double n0y, double n1x, double n1y, GUtils::LineJoin join){
+			const double hw2 = this->half_width * this->half_width,
+				cross = (n0x * n1y - n0y * n1x) / hw2,
+				dot = (n0x * n1x + n0y * n1y) / hw2;
+			// Straight continuation needs nothing
+			if(std::abs(cross) < 1e-9 && dot > 0)
+				return;
+			// Outer side of turn
+			if(cross > 0)
+				n0x = -n0x, n0y = -n0y,
+				n1x = -n1x, n1y = -n1y;
+			switch(join){
+				case GUtils::LineJoin::ROUND:
+					if(std::abs(cross) < 1e-9)
+						this->circle(p);
+					else
+						this->pie(p, n0x, n0y, std::atan2(n0x * n1y - n0y * n1x, n0x * n1x + n0y * n1y));
+					break;
+				case GUtils::LineJoin::MITER:
+					if(std::sqrt((1 + dot) / 2) >= 1 / stroke_miter_limit){
+						const StrokePoint quad[] = {p, {p.x + n0x, p.y + n0y}, {p.x + (n0x + n1x) / (1 + dot), p.y + (n0y + n1y) / (1 + dot)}, {p.x + n1x, p.y + n1y}};
+						this->polygon(quad, 4);
+						break;
+					}
+					// Falls through - miter too long for join, bevel instead
+				case GUtils::LineJoin::BEVEL:{
+						const StrokePoint triangle[] = {p, {p.x + n0x, p.y + n0y}, {p.x + n1x, p.y + n1y}};
+						this->polygon(triangle, 3);
+					}
+					break;
+			}
+		}
+		// Line end at point in direction
+		void cap(const StrokePoint& p, double dx, double dy, GUtils::LineCap cap){
+			switch(cap){
+				case GUtils::LineCap::ROUND: this->circle(p); break;
+				case GUtils::LineCap::SQUARE:{
+						const double ex = dx * this->half_width, ey = dy * this->half_width;
+						const StrokePoint quad[] = {{p.x - ey, p.y + ex}, {p.x - ey + ex, p.y + ex + ey}, {p.x + ey + ex, p.y - ex + ey}, {p.x + ey, p.y - ex}};
+						this->polygon(quad, 4);
+					}
+					break;
+				case GUtils::LineCap::FLAT: break;
+			}
+		}
+		// Stroke polyline (degenerated segments skipped)
+		void polyline(const std::vector<StrokePoint>& polyline_points, bool closed, GUtils::LineJoin join, GUtils::LineCap cap){
+			std::vector<StrokePoint> points;
+			points.reserve(polyline_points.size());
+			for(const StrokePoint& point : polyline_points)
+				if(points.empty() || !point_equal(points.back(), point))
+					points.push_back(point);
+			if(closed && points.size() > 1 && point_equal(points.front(), points.back()))
+				points.pop_back();
+			const size_t n = points.size();
+			if(n == 0)
+				return;
+			// Dot
+			if(n == 1){
+				if(!closed){
+					if(cap == GUtils::LineCap::ROUND)
+						this->circle(points[0]);
+					else if(cap == GUtils::LineCap::SQUARE)
+						this->cap(points[0], 1, 0, cap),
+						this->cap(points[0], -1, 0, cap);
+				}
+				return;
+			}
+			// Segment normals
+			const size_t segments_n = closed ? n : n - 1;
+			std::vector<StrokePoint> normals(segments_n);
+			for(size_t i = 0; i < segments_n; ++i){
+				const StrokePoint& p0 = points[i], &p1 = points[(i+1) % n];
+				const double scale = this->half_width / std::hypot(p1.x - p0.x, p1.y - p0.y);
+				normals[i] = {(p0.y - p1.y) * scale, (p1.x - p0.x) * scale};
+				this->segment(p0, p1, normals[i].x, normals[i].y);
+			}
+			// Joins between segments
+			for(size_t i = 1; i < segments_n; ++i)
+				this->join(points[i], normals[i-1].x, normals[i-1].y, normals[i].x, normals[i].y, join);
+			if(closed)
+				this->join(points[0], normals.back().x, normals.back().y, normals.front().x, normals.front().y, join);
+			// Caps at ends
+			else{
+				const double hw = this->half_width;
+				this->cap(points.front(), -normals.front().y / hw, normals.front().x / hw, cap),
+				this->cap(points.back(), normals.back().y / hw, -normals.back().x / hw, cap);
+			}
+		}
+};
+
+// Split polyline into dashes (pattern with even number of lengths, positive sum)
+static void dash_polyline(const std::vector<StrokePoint>& points, const std::vector<double>& dashes, double offset, std::vector<std::vector<StrokePoint>>& pieces){
+	// Start position in pattern
+	double total = 0;
+	for(double dash : dashes)
+		total += dash;
+	offset = std::fmod(offset, total);
+	if(offset < 0)
+		offset += total;
+	size_t dash_i = 0;
+	while(offset >= dashes[dash_i] && dashes[dash_i] > 0)	// Zero-length dash at start stays as dot
+		offset -= dashes[dash_i],
+		dash_i = (dash_i + 1) % dashes.size();
+	double rest = dashes[dash_i] - offset;
+	bool on = !(dash_i & 1);
+	if(on)
+		pieces.push_back({points.front()});
+	// Walk along lines
+	for(size_t i = 1; i < points.size(); ++i){
+		const StrokePoint& p0 = points[i-1], &p1 = points[i];
+		const double length = std::hypot(p1.x - p0.x, p1.y - p0.y);
+		double pos = 0;
+		while(length - pos > rest){
+			pos += rest;
+			const StrokePoint p{p0.x + (p1.x - p0.x) * pos / length, p0.y + (p1.y - p0.y) * pos / length};
+			if(on){
+				if(!point_equal(pieces.back().back(), p))	// Zero-length dash or dash end on vertex
+					pieces.back().push_back(p);
+			}
+			else
+				pieces.push_back({p});
+			on = !on,
+			dash_i = (dash_i + 1) % dashes.size(),
+			rest = dashes[dash_i];
+		}
+		rest -= length - pos;
+		if(on && !point_equal(pieces.back().back(), p1))
+			pieces.back().push_back(p1);
+	}
+}
+
+namespace GUtils{
+	std::vector<PathSegment> path_stroke(const std::vector<PathSegment>& path, double width, LineJoin join, LineCap cap, double dash_offset, const std::vector<double>& dashes){
+		std::vector<PathSegment> outline;
+		if(width <= 0)
+			return outline;
+		StrokeOutline stroker(outline, width / 2);
+		// Usable dash pattern (odd number of lengths repeats, like cairo)?
+		std::vector<double> pattern(dashes);
+		double pattern_sum = 0;
+		for(double dash : dashes)
+			if(dash < 0)
+				pattern_sum = -1;
+			else if(pattern_sum >= 0)
+				pattern_sum += dash;
+		if(pattern_sum <= 0)
+			pattern.clear();
+		else if(pattern.size() & 1)
+			pattern.insert(pattern.end(), dashes.begin(), dashes.end());
+		// Collect contours & stroke them
+		std::vector<StrokePoint> points;
+		std::vector<std::vector<StrokePoint>> pieces;
+		auto stroke_contour = [&](bool closed){
+			if(points.empty())
+				return;
+			// Closed contour without own closing point
+			if(closed && points.size() > 1 && point_equal(points.front(), points.back()))
+				points.pop_back();
+			if(pattern.empty())
+				stroker.polyline(points, closed && points.size() > 1, join, cap);
+			else{
+				if(closed)
+					points.push_back(points.front());
+				pieces.clear(),
+				dash_polyline(points, pattern, dash_offset, pieces);
+				for(const std::vector<StrokePoint>& piece : pieces)
+					stroker.polyline(piece, false, join, cap);
+			}
+			points.clear();
+		};
+		StrokePoint last{0, 0};
+		for(const PathSegment& segment : path)
+			switch(segment.type){
+				case PathSegment::Type::MOVE:
+					stroke_contour(false),
+					last = {segment.x, segment.y},
+					points.push_back(last);
+					break;
+				case PathSegment::Type::LINE:
+				case PathSegment::Type::CURVE:
+					if(points.empty())
+						points.push_back(last);
+					last = {segment.x, segment.y};
+					if(!point_equal(points.back(), last))
+						points.push_back(last);
+					break;
+				case PathSegment::Type::CLOSE:
+					// Following lines continue from contour start
+					if(!points.empty())
+						last = points.front();
+					stroke_contour(true);
+					break;
+			}
+		stroke_contour(false);
+		return outline;
+	}
+
+	std::shared_ptr<const std::vector<PathSegment>> path_stroke_cached(const std::vector<PathSegment>& path, double width, LineJoin join, LineCap cap,
+			double dash_offset, const std::vector<double>& dashes){
+		static PathCache<StrokeParams, StrokeParamsHash> stroked_cache(static_cast<size_t>(STROKE_CACHE_SIZE) << 20);
+		return stroked_cache.get(path, {width, join, cap, dash_offset, dashes}, [](const std::vector<PathSegment>& source, const StrokeParams& params){
+			return path_stroke(source, params.width, params.join, params.cap, params.dash_offset, params.dashes);
+		});
+	}
+}
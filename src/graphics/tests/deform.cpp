@@ -0,0 +1,46 @@
+/*
+Project: SSBRenderer
+File: deform.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../gutils.hpp"
+#include <config.h>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using namespace GUtils;
+using PType = PathSegment::Type;
+
+int main(){
+	// Points moved by formulas with progress
+	std::vector<PathSegment> line{{PType::MOVE, 0, 0}, {PType::LINE, 10, 5}, {PType::CLOSE, 0, 0}};
+	path_deform(line, "x + t*10", "y * 2", 0.5);
+	if(line[0].x != 5 || line[0].y != 0 || line[1].x != 15 || line[1].y != 10 || line[2].type != PType::CLOSE)
+		throw std::logic_error("Path points not deformed");
+	// Cached deform flattens curves, keeps coordinates without formula (same as identity formula) & quantizes progress
+	const std::vector<PathSegment> curve{{PType::MOVE, 0, 0}, {PType::CURVE, 0, 10}, {PType::CURVE, 10, 10}, {PType::CURVE, 10, 0}};
+	const auto deformed = path_deform_cached(curve, 0.05, "x + t", "", 0.25);
+	if(deformed->size() <= curve.size() || deformed->front().x != 0.25 || deformed->back().x != 10.25 || deformed->back().y != 0)
+		throw std::logic_error("Cached path not flattened & deformed");
+	for(const PathSegment& segment : *deformed)
+		if(segment.type == PType::CURVE)
+			throw std::logic_error("Curve left in deformed path");
+	const std::vector<PathSegment> curve_copy(curve);
+	if(path_deform_cached(curve_copy, 0.05, "x + t", "", 0.25 + 0.1 / DEFORM_STEPS) != deformed ||
+		path_deform_cached(curve, 0.05, "x + t", "", 0.75) == deformed ||
+		path_deform_cached(curve, 0.05, "x + t", "y", 0.25) != deformed ||
+		path_deform_cached(curve, 0.05, "x + t", "y * 2", 0.25) == deformed)
+		throw std::logic_error("Deform cache lookup wrong");
+	std::cout << "Deformed curve to " << deformed->size() << " segments" << std::endl;
+	return 0;
+}
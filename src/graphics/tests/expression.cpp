@@ -0,0 +1,61 @@
+/*
+Project: SSBRenderer
+File: expression.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../expression.hpp"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+
+int main(){
+	// Variable values (more than one register width & a remainder)
+	const size_t n = 1003;
+	std::vector<double> x(n), y(n), t(n, 0.25), results(n);
+	for(size_t i = 0; i < n; ++i)
+		x[i] = i * 0.37 - 100,
+		y[i] = std::sin(i) * 50;
+	const double* const values[] = {x.data(), y.data(), t.data()};
+	// Compiled formulas against reference functions
+	const struct{
+		const char* formula;
+		std::function<double(double,double,double)> reference;
+	} formulas[] = {
+		{"x + sin(y/10 + t*6)*5", [](double x, double y, double t){return x + std::sin(y/10 + t*6)*5;}},
+		{"2*x^2 - 3*y + 1e-3", [](double x, double y, double){return 2*x*x - 3*y + 1e-3;}},
+		{"x > 0 ? sqrt(x) : -abs(y)", [](double x, double y, double){return x > 0 ? std::sqrt(x) : -std::fabs(y);}},
+		{"min(x, y, 3) + max(x, y)", [](double x, double y, double){return std::min(std::min(x, y), 3.0) + std::max(x, y);}},
+		{"x < y && y != 0 || t == 0.25", [](double x, double y, double t){return static_cast<double>((x < y && y != 0) || t == 0.25);}},
+		{"(x+1)*(y-1)/(t+2)", [](double x, double y, double t){return (x+1)*(y-1)/(t+2);}}
+	};
+	for(const auto& formula : formulas){
+		GUtils::Expression expression(formula.formula, {"x", "y", "t"});
+		if(!expression.compiled())
+			throw std::logic_error(std::string("Formula not compiled: ") + formula.formula);
+		// Evaluate twice (registers reused)
+		for(int pass = 0; pass < 2; ++pass){
+			if(!expression.evaluate(values, results.data(), n - pass * 500))
+				throw std::logic_error(std::string("Formula evaluation failed: ") + formula.formula);
+			for(size_t i = 0; i < n - pass * 500; ++i){
+				const double reference = formula.reference(x[i], y[i], t[i]);
+				if(std::fabs(reference - results[i]) > 1e-9 * std::max(1.0, std::fabs(reference)))
+					throw std::logic_error(std::string("Formula result differs: ") + formula.formula);
+			}
+		}
+	}
+	// Unsupported syntax left to muParser
+	if(GUtils::Expression("x = 1", {"x"}).compiled() || GUtils::Expression("foo(x)", {"x"}).compiled())
+		throw std::logic_error("Unsupported formula compiled");
+	std::cout << "Expression compiler matches " << sizeof(formulas) / sizeof(*formulas) << " reference formulas" << std::endl;
+	return 0;
+}
@@ -0,0 +1,75 @@
+/*
+Project: SSBRenderer
+File: flatten.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../gutils.hpp"
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using namespace GUtils;
+using PType = PathSegment::Type;
+
+int main(int argc, char** argv){
+	// Generate dense glyph-like outlines (outer contour with curved serifs & inner round counter)
+	const unsigned long glyphs_n = argc > 1 ? std::stoul(argv[1]) : 10000;
+	std::vector<PathSegment> path;
+	for(unsigned long i = 0; i < glyphs_n; ++i){
+		const double x = i % 100 * 40,
+			y = i / 100 * 50,
+			bend = 2 + i % 7;
+		path.push_back({PType::MOVE, x, y}),
+		path.push_back({PType::LINE, x + 30, y}),
+		path.push_back({PType::CURVE, x + 30 + bend, y + 10}),
+		path.push_back({PType::CURVE, x + 30 - bend, y + 30}),
+		path.push_back({PType::CURVE, x + 30, y + 40}),
+		path.push_back({PType::CURVE, x + 20, y + 45 + bend}),
+		path.push_back({PType::CURVE, x + 10, y + 45 - bend}),
+		path.push_back({PType::CURVE, x, y + 40}),
+		path.push_back({PType::CLOSE, 0, 0}),
+		path.push_back({PType::MOVE, x + 15, y + 10});
+		auto counter = path_by_arc(x + 15, y + 10, x + 15, y + 20, 2 * M_PI);
+		path.insert(path.end(), counter.begin(), counter.end()),
+		path.push_back({PType::CLOSE, 0, 0});
+	}
+	// Flatten with decreasing tolerance & measure time
+	for(double tolerance : {0.1, 0.02, 0.005}){
+		std::vector<PathSegment> flat_path = path;
+		const auto start = std::chrono::steady_clock::now();
+		path_flatten(flat_path, tolerance);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		// Check result: no curves left, contours still start & close
+		size_t moves = 0, closes = 0;
+		for(auto& segment : flat_path)
+			switch(segment.type){
+				case PType::MOVE: ++moves; break;
+				case PType::LINE: break;
+				case PType::CURVE: throw std::logic_error("Curve left in flattened path");
+				case PType::CLOSE: ++closes; break;
+			}
+		if(moves != glyphs_n * 2 || closes != glyphs_n * 2 || flat_path.back().type != PType::CLOSE || (flat_path.end()-2)->x != path[path.size()-2].x)
+			throw std::logic_error("Flattened path contours broken");
+		std::cout << glyphs_n << " glyphs (" << path.size() << " segments) flattened with tolerance " << tolerance << " to " << flat_path.size() << " segments in " << seconds << " seconds" << std::endl;
+		// Flatten separated path storage
+		Path soa_path(path);
+		const auto soa_start = std::chrono::steady_clock::now();
+		path_flatten(soa_path, tolerance);
+		const double soa_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - soa_start).count();
+		if(soa_path.size() != flat_path.size())
+			throw std::logic_error("Separated path flattening differs");
+		std::cout << "Separated path flattened in " << soa_seconds << " seconds" << std::endl;
+	}
+	return 0;
+}
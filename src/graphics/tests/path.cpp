@@ -47,5 +47,25 @@ int main(){
         print_path(path_transform(path, mat.translate(5, 7.2, -3))),
         print_path(path_flatten(path, 0.035)),
 	print_path(path_by_arc(0, 30, 30, 30, 3.2));
+	// Separated path storage has to give same results
+	std::vector<PathSegment> segments = path_by_arc(3, 4, 10, 12, 5.5);
+	segments.insert(segments.begin(), {PType::MOVE, 3, 4}),
+	segments.push_back({PType::CLOSE, 0, 0}),
+	segments.push_back({PType::MOVE, -2, 50}),
+	segments.push_back({PType::LINE, 1, 1});
+	Path soa_path(segments);
+	path_transform(path_flatten(soa_path, 0.05), mat.rotate_z(0.7));
+	path_transform(path_flatten(segments, 0.05), mat);
+	const std::vector<PathSegment> soa_segments = soa_path.segments();
+	if(soa_segments.size() != segments.size())
+		throw std::logic_error("Separated path flattening differs");
+	for(size_t i = 0; i < segments.size(); ++i)
+		if(soa_segments[i].type != segments[i].type ||
+			(segments[i].type != PType::CLOSE && (soa_segments[i].x != segments[i].x || soa_segments[i].y != segments[i].y)))
+			throw std::logic_error("Separated path transformation differs");
+	double soa_x0, soa_y0, soa_x1, soa_y1;
+	if(!path_extents(soa_path, &soa_x0, &soa_y0, &soa_x1, &soa_y1) || !path_extents(segments, &x0, &y0, &x1, &y1) ||
+		soa_x0 != x0 || soa_y0 != y0 || soa_x1 != x1 || soa_y1 != y1)
+		throw std::logic_error("Separated path extents differ");
 	return 0;
 }
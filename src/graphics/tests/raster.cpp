@@ -0,0 +1,105 @@
+/*
+Project: SSBRenderer
+File: raster.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../gutils.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using namespace GUtils;
+using PType = PathSegment::Type;
+
+// Rectangle contour (clockwise or counter-clockwise)
+static void add_rect(std::vector<PathSegment>& path, double x0, double y0, double x1, double y1, bool ccw = false){
+	path.push_back({PType::MOVE, x0, y0}),
+	path.push_back({PType::LINE, ccw ? x0 : x1, ccw ? y1 : y0}),
+	path.push_back({PType::LINE, x1, y1}),
+	path.push_back({PType::LINE, ccw ? x1 : x0, ccw ? y0 : y1}),
+	path.push_back({PType::CLOSE, 0, 0});
+}
+
+int main(){
+	// Pixel-aligned square covers full pixels in tight mask
+	std::vector<PathSegment> square;
+	add_rect(square, 2, 3, 10, 7);
+	int mask_x, mask_y;
+	Image2D<> mask = path_rasterize(square, FillRule::NONZERO, mask_x, mask_y);
+	if(mask_x != 2 || mask_y != 3 || mask.get_width() != 8 || mask.get_height() != 4)
+		throw std::logic_error("Mask isn't bounding box of path");
+	for(size_t i = 0; i < mask.get_size(); ++i)
+		if(mask.get_data()[i] != 255)
+			throw std::logic_error("Square isn't filled completely");
+	// Half-pixel offset square covers border pixels half
+	std::vector<PathSegment> half_square;
+	add_rect(half_square, 0.5, 0.5, 8.5, 8.5, true);
+	mask = path_rasterize(half_square, FillRule::NONZERO, mask_x, mask_y);
+	if(mask.get_width() != 9 || mask.get_data()[4] < 126 || mask.get_data()[4] > 129 || mask.get_data()[0] < 62 || mask.get_data()[0] > 65 || mask.get_data()[4 * 9 + 4] != 255)
+		throw std::logic_error("Square border coverage isn't right");
+	// Nested squares: same direction fills by nonzero rule, even-odd rule leaves hole
+	std::vector<PathSegment> nested;
+	add_rect(nested, 0, 0, 20, 20),
+	add_rect(nested, 5, 5, 15, 15);
+	const unsigned center = 10 * 20 + 10;
+	if(path_rasterize(nested, FillRule::NONZERO, mask_x, mask_y).get_data()[center] != 255 ||
+		path_rasterize(nested, FillRule::EVENODD, mask_x, mask_y).get_data()[center] != 0 ||
+		path_rasterize(Path(nested), FillRule::EVENODD, mask_x, mask_y).get_data()[center] != 0)
+		throw std::logic_error("Fill rules aren't respected");
+	// Invalid coordinates give empty mask
+	std::vector<PathSegment> invalid;
+	add_rect(invalid, 0, 0, NAN, 10);
+	if(path_rasterize(invalid, FillRule::NONZERO, mask_x, mask_y).get_size() || mask_x || mask_y)
+		throw std::logic_error("Invalid path rasterized");
+	// Clipped mask equals unclipped one in clip box (edges crossing clip borders keep winding)
+	std::vector<PathSegment> slanted{{PType::MOVE, -7.3, 2.6}, {PType::LINE, 18.2, -4.1}, {PType::LINE, 9.7, 21.4}, {PType::CLOSE, 0, 0}};
+	const Image2D<> full = path_rasterize(slanted, FillRule::NONZERO, mask_x, mask_y);
+	const int full_x = mask_x, full_y = mask_y;
+	const Image2D<> clipped = path_rasterize(slanted, FillRule::NONZERO, 2, 3, 10, 12, mask_x, mask_y);
+	if(mask_x != 2 || mask_y != 3 || clipped.get_width() != 10 || clipped.get_height() != 12)
+		throw std::logic_error("Mask isn't limited to clip box");
+	for(unsigned y = 0; y < clipped.get_height(); ++y)
+		for(unsigned x = 0; x < clipped.get_width(); ++x)
+			if(std::abs(clipped.get_data()[y * clipped.get_stride() + x] - full.get_data()[(y + mask_y - full_y) * full.get_stride() + x + mask_x - full_x]) > 1)
+				throw std::logic_error("Clipped coverage isn't right");
+	// Huge paths cost by clip box, too big unclipped masks aren't allocated
+	std::vector<PathSegment> huge;
+	add_rect(huge, -1e8, -1e8, 1e8, 1e8);
+	mask = path_rasterize(huge, FillRule::NONZERO, 0, 0, 16, 16, mask_x, mask_y);
+	if(mask.get_width() != 16 || mask.get_height() != 16 || mask.get_data()[0] != 255 || mask.get_data()[16 * 16 - 1] != 255)
+		throw std::logic_error("Huge path not clipped");
+	if(path_rasterize(huge, FillRule::NONZERO, mask_x, mask_y).get_size() ||
+		path_rasterize(huge, FillRule::NONZERO, 100, 100, 0, 10, mask_x, mask_y).get_size())
+		throw std::logic_error("Unaddressable or empty mask allocated");
+	// Circle area by coverage sum
+	std::vector<PathSegment> circle{{PType::MOVE, 100, 50}};
+	auto arc = path_by_arc(100, 50, 50, 50, 2 * M_PI);
+	circle.insert(circle.end(), arc.begin(), arc.end()),
+	path_flatten(circle, 0.01);
+	mask = path_rasterize(circle, FillRule::NONZERO, mask_x, mask_y);
+	double area = 0;
+	for(size_t i = 0; i < mask.get_size(); ++i)
+		area += mask.get_data()[i] / 255.0;
+	if(std::abs(area - M_PI * 50 * 50) > 10)
+		throw std::logic_error("Circle coverage isn't right");
+	// Measure big circle rasterization
+	Matrix4x4d mat;
+	path_transform(circle, mat.scale(10, 10, 1));
+	const unsigned rounds = 100;
+	const auto start = std::chrono::steady_clock::now();
+	for(unsigned i = 0; i < rounds; ++i)
+		mask = path_rasterize(circle, FillRule::NONZERO, mask_x, mask_y);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << rounds << " circles (" << mask.get_width() << 'x' << mask.get_height() << ", " << circle.size() << " segments) rasterized in " << seconds << " seconds" << std::endl;
+	return 0;
+}
@@ -0,0 +1,59 @@
+/*
+Project: SSBRenderer
+File: spanmask.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../gutils.hpp"
+#include <stdexcept>
+
+using namespace GUtils;
+
+// Mask filled with one coverage
+static Image2D<> uniform_mask(unsigned width, unsigned height, unsigned char coverage){
+	Image2D<> mask(width, height, width);
+	std::fill(mask.get_data(), mask.get_data() + mask.get_size(), coverage);
+	return mask;
+}
+
+int main(){
+	// Unite two overlapping squares
+	SpanMask stencil;
+	if(!stencil.empty())
+		throw std::logic_error("New stencil isn't empty");
+	stencil.unite(uniform_mask(10, 10, 255), 0, 0),
+	stencil.unite(uniform_mask(10, 10, 128), 5, 5);
+	if(stencil.get(2, 2) != 255 || stencil.get(7, 7) != 255 || stencil.get(12, 12) != 128 || stencil.get(2, 12) != 0 || stencil.get(-1, 0) != 0 || stencil.get(0, 20) != 0)
+		throw std::logic_error("Unite coverage isn't right");
+	// Subtract hole, partly
+	stencil.subtract(uniform_mask(4, 4, 255), 3, 3),
+	stencil.subtract(uniform_mask(20, 1, 128), 0, 14);
+	if(stencil.get(4, 4) != 0 || stencil.get(2, 4) != 255 || stencil.get(12, 14) != 64)
+		throw std::logic_error("Subtract coverage isn't right");
+	// Clip mask by inside & outside
+	Image2D<> mask = uniform_mask(20, 1, 200);
+	stencil.clip(mask, -5, 2, true);
+	if(mask.get_data()[0] != 0 || mask.get_data()[5] != 200 || mask.get_data()[14] != 200 || mask.get_data()[15] != 0)
+		throw std::logic_error("Inside clipping isn't right");
+	mask = uniform_mask(20, 1, 200),
+	stencil.clip(mask, -5, 2, false);
+	if(mask.get_data()[0] != 200 || mask.get_data()[5] != 0 || mask.get_data()[14] != 0 || mask.get_data()[15] != 200)
+		throw std::logic_error("Outside clipping isn't right");
+	// Subtract everything & clear
+	stencil.subtract(uniform_mask(20, 20, 255), 0, 0);
+	if(!stencil.empty())
+		throw std::logic_error("Stencil isn't empty after subtraction");
+	stencil.unite(uniform_mask(3, 3, 255), 100, 100),
+	stencil.clear();
+	if(!stencil.empty() || stencil.get(101, 101) != 0)
+		throw std::logic_error("Stencil isn't empty after clear");
+	return 0;
+}
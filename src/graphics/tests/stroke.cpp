@@ -0,0 +1,83 @@
+/*
+Project: SSBRenderer
+File: stroke.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../gutils.hpp"
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+using namespace GUtils;
+using PType = PathSegment::Type;
+
+// Area of stroke outline by rasterized coverage
+static double stroke_area(const std::vector<PathSegment>& path, double width, LineJoin join, LineCap cap, double dash_offset = 0, const std::vector<double>& dashes = {}){
+	int mask_x, mask_y;
+	const Image2D<> mask = path_rasterize(path_stroke(path, width, join, cap, dash_offset, dashes), FillRule::NONZERO, mask_x, mask_y);
+	double area = 0;
+	for(size_t i = 0; i < mask.get_size(); ++i)
+		area += mask.get_data()[i] / 255.0;
+	return area;
+}
+
+static void check_area(const char* name, double area, double expected, double tolerance = 0.005){
+	std::cout << name << ": " << area << " (expected " << expected << ')' << std::endl;
+	if(std::abs(area - expected) > 0.1 + expected * tolerance)
+		throw std::logic_error(std::string("Stroke area wrong: ") + name);
+}
+
+static bool path_equal(const std::vector<PathSegment>& path1, const std::vector<PathSegment>& path2){
+	return path1.size() == path2.size() &&
+		std::equal(path1.begin(), path1.end(), path2.begin(), [](const PathSegment& a, const PathSegment& b){
+			return a.type == b.type && a.x == b.x && a.y == b.y;
+		});
+}
+
+int main(){
+	// Line with caps
+	const std::vector<PathSegment> line{{PType::MOVE, 5, 5}, {PType::LINE, 15, 5}};
+	check_area("Flat cap", stroke_area(line, 2, LineJoin::ROUND, LineCap::FLAT), 20);
+	check_area("Square cap", stroke_area(line, 2, LineJoin::ROUND, LineCap::SQUARE), 24);
+	check_area("Round cap", stroke_area(line, 2, LineJoin::ROUND, LineCap::ROUND), 20 + M_PI);
+	// Closed square with joins
+	const std::vector<PathSegment> square{{PType::MOVE, 5, 5}, {PType::LINE, 15, 5}, {PType::LINE, 15, 15}, {PType::LINE, 5, 15}, {PType::CLOSE, 0, 0}};
+	check_area("Miter join", stroke_area(square, 2, LineJoin::MITER, LineCap::FLAT), 80);
+	check_area("Bevel join", stroke_area(square, 2, LineJoin::BEVEL, LineCap::FLAT), 78);
+	check_area("Round join", stroke_area(square, 2, LineJoin::ROUND, LineCap::FLAT), 76 + M_PI);
+	// Dashes (odd pattern repeats)
+	check_area("Dashes", stroke_area(line, 2, LineJoin::ROUND, LineCap::FLAT, 0, {2, 2}), 12);
+	check_area("Dashes with offset", stroke_area(line, 2, LineJoin::ROUND, LineCap::FLAT, 1, {2}), 10);
+	// Zero-length dashes as dots & dash ends on vertices (no degenerated segments)
+	check_area("Dash dots", stroke_area(line, 2, LineJoin::ROUND, LineCap::ROUND, 0, {0, 2}), 5 * M_PI, 0.02);
+	check_area("Dashes on corners", stroke_area(square, 2, LineJoin::ROUND, LineCap::SQUARE, 0, {10, 10}), 48);
+	// Stroke of curved path overlaps itself without holes (overlaps accumulate at anti-aliased edges, so a bit more area)
+	std::vector<PathSegment> circle{{PType::MOVE, 30, 10}};
+	const auto arc = path_by_arc(30, 10, 20, 10, 2 * M_PI);
+	circle.insert(circle.end(), arc.begin(), arc.end()),
+	circle.push_back({PType::CLOSE, 0, 0}),
+	path_flatten(circle, 0.01);
+	check_area("Circle ring", stroke_area(circle, 4, LineJoin::ROUND, LineCap::FLAT), M_PI * (12 * 12 - 8 * 8), 0.02);
+	// Cached outlines are shared by equal path content & line style
+	const std::vector<PathSegment> square_copy(square);
+	const auto stroked = path_stroke_cached(square, 2, LineJoin::MITER, LineCap::FLAT, 0, {3, 1});
+	if(stroked != path_stroke_cached(square_copy, 2, LineJoin::MITER, LineCap::FLAT, 0, {3, 1}) ||
+		stroked == path_stroke_cached(square, 2, LineJoin::MITER, LineCap::FLAT, 0, {3, 2}) ||
+		!path_equal(*stroked, path_stroke(square, 2, LineJoin::MITER, LineCap::FLAT, 0, {3, 1})))
+		throw std::logic_error("Stroke cache wrong");
+	// Paths with NaN coordinates are found again, NaN line styles aren't cached
+	const std::vector<PathSegment> nan_line{{PType::MOVE, 5, NAN}, {PType::LINE, 15, 5}};
+	if(path_stroke_cached(nan_line, 2, LineJoin::ROUND, LineCap::FLAT) != path_stroke_cached(nan_line, 2, LineJoin::ROUND, LineCap::FLAT) ||
+		path_stroke_cached(line, NAN, LineJoin::ROUND, LineCap::FLAT) == path_stroke_cached(line, NAN, LineJoin::ROUND, LineCap::FLAT))
+		throw std::logic_error("Stroke cache lookup with NaN wrong");
+	return 0;
+}
@@ -17,6 +17,7 @@ Permission is granted to anyone to use this software for any purpose, including
 #include <iterator>
 #include <algorithm>
 #include <stdexcept>
+#include <cmath>
 
 int main(){
 	double vec[] = {1, 0, 0}, *vec_end = vec+(sizeof(vec)/sizeof(*vec));
@@ -26,5 +27,21 @@ int main(){
 	if(!mat.invert())
 		throw std::logic_error("Matrix inversion failed");
 	std::copy(mat.transform3d(vec), vec_end, cout);
+	// Batch transformations have to match single ones
+	mat.rotate_z(0.5).translate(2, -3, 0);
+	const double xs_orig[] = {1, 2, 3, 4, 5}, ys_orig[] = {-1, 0.5, 7, 8, -9};
+	double xs[5], ys[5], vecs[10];
+	for(unsigned i = 0; i < 5; ++i)
+		xs[i] = vecs[i<<1] = xs_orig[i],
+		ys[i] = vecs[(i<<1)+1] = ys_orig[i];
+	mat.transform2d(xs, ys, 5),
+	mat.transform2d(vecs, 5);
+	for(unsigned i = 0; i < 5; ++i){
+		double vec2d[] = {xs_orig[i], ys_orig[i]};
+		mat.transform2d(vec2d);
+		if(std::abs(xs[i] - vec2d[0]) > 1e-9 || std::abs(ys[i] - vec2d[1]) > 1e-9 ||
+			std::abs(vecs[i<<1] - vec2d[0]) > 1e-9 || std::abs(vecs[(i<<1)+1] - vec2d[1]) > 1e-9)
+			throw std::logic_error("Batch transformations differ");
+	}
 	return 0;
 }
@@ -19,6 +19,10 @@ Permission is granted to anyone to use this software for any purpose, including
 #include <vector>
 #include <memory>
 #include <map>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
 namespace SSB{
 	// General SSB exception
@@ -414,8 +418,8 @@ namespace SSB{
 		public:
 			Duration start, end; // 'Unset' in case of maximum values
 			std::string progress_formula;   // 'Unset' in case of emtpiness
-			std::vector<std::shared_ptr<Object>> objects;
-			Animate(Duration start, Duration end, const std::string& progress_formula, const std::vector<std::shared_ptr<Object>>& objects) : Tag(Tag::Type::ANIMATE), start(start), end(end), progress_formula(progress_formula), objects(objects){}
+			std::vector<Object*> objects;
+			Animate(Duration start, Duration end, const std::string& progress_formula, std::vector<Object*>&& objects) : Tag(Tag::Type::ANIMATE), start(start), end(end), progress_formula(progress_formula), objects(std::move(objects)){}
 	};
 
 	// Karaoke time state
@@ -479,11 +483,89 @@ namespace SSB{
 		unsigned width = 0, height = 0;
 	};
 
+	// Memory pool for objects, which get freed all at once with the pool
+	class ObjectArena{
+		private:
+			// Memory blocks & objects to destruct are linked backwards
+			struct Block{
+				Block* prev;
+			} *last_block = nullptr;
+			struct ObjectNode{
+				ObjectNode* prev;
+				Object* object;
+			} *last_object = nullptr;
+			char* block_pos = nullptr, *block_end = nullptr;
+			size_t next_block_size = 512;
+			void release(){
+				for(; this->last_object; this->last_object = this->last_object->prev)
+					this->last_object->object->~Object();
+				while(this->last_block){
+					Block* prev = this->last_block->prev;
+					::operator delete(this->last_block);
+					this->last_block = prev;
+				}
+			}
+		public:
+			ObjectArena() = default;
+			~ObjectArena(){this->release();}
+			// No copy, just move
+			ObjectArena(const ObjectArena&) = delete;
+			ObjectArena& operator=(const ObjectArena&) = delete;
+			ObjectArena(ObjectArena&& other) noexcept{*this = std::move(other);}
+			ObjectArena& operator=(ObjectArena&& other) noexcept{
+				if(this != &other)
+					this->release(),
+					this->last_block = other.last_block, this->last_object = other.last_object,
+					this->block_pos = other.block_pos, this->block_end = other.block_end,
+					this->next_block_size = other.next_block_size,
+					other.last_block = nullptr, other.last_object = nullptr,
+					other.block_pos = other.block_end = nullptr;
+				return *this;
+			}
+			// Get aligned memory from current block or a new one (growing till 64kB)
+			void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)){
+				char* pos = this->block_pos + (-reinterpret_cast<uintptr_t>(this->block_pos) & (alignment - 1));
+				if(!this->block_pos || pos + size > this->block_end){
+					const size_t block_size = std::max(this->next_block_size, sizeof(Block) + alignment + size);
+					Block* block = static_cast<Block*>(::operator new(block_size));
+					block->prev = this->last_block,
+					this->last_block = block,
+					this->block_end = reinterpret_cast<char*>(block) + block_size,
+					this->next_block_size = std::min<size_t>(this->next_block_size << 1, 65536);
+					pos = reinterpret_cast<char*>(block + 1),
+					pos += -reinterpret_cast<uintptr_t>(pos) & (alignment - 1);
+				}
+				this->block_pos = pos + size;
+				return pos;
+			}
+			// Register object constructed in arena memory for destruction
+			template<typename T>
+			T* add(T* object){
+				ObjectNode* node = static_cast<ObjectNode*>(this->allocate(sizeof(ObjectNode), alignof(ObjectNode)));
+				node->prev = this->last_object,
+				node->object = object,
+				this->last_object = node;
+				return object;
+			}
+	};
+
 	// Event with rendering informations
 	struct Event{
 		Time start_ms = 0, end_ms = 0;
-		std::vector<std::shared_ptr<Object>> objects;
+		ObjectArena arena;	// Owner of objects
+		std::vector<Object*> objects;
 		bool static_tags = true;
+		std::string source;	// Script line (just kept on request for reparsing)
+		std::vector<std::string> style_names;	// Styles inserted by line (kept with source, for reparsing on style edits)
+		bool parsed = true;	// Objects parsed from source yet?
+		std::shared_ptr<Event> style;	// Owner of pre-parsed style objects (at objects begin)
+	};
+
+	// Unparsed event as time range & line in script memory
+	struct EventLine{
+		Time start_ms, end_ms;
+		const char* line;
+		size_t line_size;
 	};
 
 	// Complete data from any script
@@ -493,5 +575,12 @@ namespace SSB{
 		Frame frame;
 		std::map<std::string, std::string>/*Name, Content*/ styles;
 		std::vector<Event> events;
+		std::vector<EventLine> event_lines;	// Instead of events by indexing parser
 	};
 }	// namespace SSB
+
+// Construct objects in arena memory (SSB::ObjectArena::add registers them for destruction)
+inline void* operator new(size_t size, SSB::ObjectArena& arena){
+	return arena.allocate(size);
+}
+inline void operator delete(void*, SSB::ObjectArena&){}
@@ -13,20 +13,24 @@ Permission is granted to anyone to use this software for any purpose, including
 */
 
 #include "SSBParser.hpp"
+#include "SSBSerializer.hpp"
+#include "../graphics/threads.hpp"
 #include <config.h>
-#include "../utils/string.hpp"
 #include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <iterator>
 
 // Parses SSB time and converts to milliseconds
 template<typename T>
-static inline bool parse_time(const std::string& s, T& t){
+static inline bool parse_time(stdex::string_view s, T& t){
 	// Check for empty timestamp
 	if(s.empty())
 		return false;
 	// Time sections
 	enum class TimeUnit{MS, MS_10, MS_100, MS_LIMIT, SEC, SEC_10, SEC_LIMIT, MIN, MIN_10, MIN_LIMIT, H, H_10, END} unit = TimeUnit::MS;
 	// Iterate through timestamp characters
-	for(auto it = s.crbegin(); it != s.crend(); ++it)
+	for(auto it = s.rbegin(); it != s.rend(); ++it)
 		switch(unit){
 			case TimeUnit::MS:
 				if(*it >= '0' && *it <= '9'){
@@ -124,26 +128,56 @@ static inline bool parse_time(const std::string& s, T& t){
 	return true;
 }
 
+// Extracts next whitespace-separated word
+static inline bool next_word(stdex::string_view& s, stdex::string_view& word){
+	const stdex::string_view::size_type pos_start = s.find_first_not_of(" \t\n\r\f\v");
+	if(pos_start == stdex::string_view::npos){
+		s = stdex::string_view(s.end(), 0);
+		return false;
+	}
+	const stdex::string_view::size_type pos_end = s.find_first_of(" \t\n\r\f\v", pos_start);
+	word = s.substr(pos_start, pos_end - pos_start),
+	s.remove_prefix(pos_end == stdex::string_view::npos ? s.length() : pos_end);
+	return true;
+}
+
+// Hashes tag name to 7 bits (seed makes registered tag names collision-free)
+static constexpr uint32_t tag_hash_mix(uint32_t h){
+	return h ^ h >> 16;
+}
+static constexpr uint32_t tag_hash(const char* name, size_t n, uint32_t h = 138104){
+	return n ? tag_hash(name+1, n-1, h * 31 + static_cast<unsigned char>(*name)) : tag_hash_mix(tag_hash_mix(h) * 0x45d9f3bu) & 0x7f;
+}
+template<size_t N>
+static constexpr uint32_t tag_hash(const char (&name)[N]){
+	return tag_hash(name, N-1);
+}
+
 namespace SSB{
 	// Parser implementations
-	#define ADD_OBJECT(obj) event.objects.emplace_back(new obj)
+	#define ADD_OBJECT(obj) event.objects.push_back(event.arena.add(new(event.arena) obj))
 	#define THROW_STRONG_ERROR(msg) if(this->level != Parser::Level::OFF) throw Exception(msg)
 	#define THROW_WEAK_ERROR(msg) if(this->level == Parser::Level::ALL) throw Exception(msg)
-	void Parser::parse_geometry(std::string geometry, Geometry::Type geometry_type, Event& event) throw(Exception){
+	void Parser::parse_geometry(stdex::string_view geometry, Geometry::Type geometry_type, Event& event) throw(Exception){
 		switch(geometry_type){
 			case Geometry::Type::POINTS:{
 					// Points buffer
 					std::vector<Point> points;
 					// Iterate through numbers
-					std::istringstream points_stream(geometry);
+					stdex::string_view points_token;
 					Point point;
-					while(points_stream >> point.x)
-						if(points_stream >> point.y)
+					bool points_valid = true;
+					while(points_valid && next_word(geometry, points_token))
+						if(!stdex::string_to_number(points_token, point.x))
+							points_valid = false;
+						else if(next_word(geometry, points_token) && stdex::string_to_number(points_token, point.y))
 							points.push_back(point);
-						else
+						else{
 							THROW_WEAK_ERROR("Points must have 2 numbers");
-					// Check for successfull streaming end
-					if((points_stream >> std::ws).eof())
+							points_valid = false;
+						}
+					// Check for successfull parsing end
+					if(points_valid)
 						ADD_OBJECT(Points(points));
 					else
 						THROW_WEAK_ERROR("Points are invalid");
@@ -153,11 +187,10 @@ namespace SSB{
 					// Path segments buffer
 					std::vector<Path::Segment> path;
 					// Iterate through words
-					std::istringstream path_stream(geometry);
-					std::string path_token;
+					stdex::string_view path_token;
 					Path::Segment segments[3];
 					segments[0].type = Path::SegmentType::MOVE_TO;
-					while(path_stream >> path_token)
+					while(next_word(geometry, path_token))
 						// Save next segment type
 						if(path_token == "m")
 							segments[0].type = Path::SegmentType::MOVE_TO;
@@ -172,37 +205,39 @@ namespace SSB{
 							path.push_back({Path::SegmentType::CLOSE, 0, 0});
 						// Complete next segment
 						}else{
-							// Put token back in stream for rereading
-							path_stream.seekg(-static_cast<long>(path_token.length()), std::istringstream::cur);
-							// Parse segment data
+							// Parse segment data (token is first number)
+							bool segment_valid = false;
 							switch(segments[0].type){
 								case Path::SegmentType::MOVE_TO:
 								case Path::SegmentType::LINE_TO:
-									if(path_stream >> segments[0].point.x &&
-										path_stream >> segments[0].point.y)
+									if(stdex::string_to_number(path_token, segments[0].point.x) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[0].point.y)){
 										path.push_back(segments[0]);
-									else
+										segment_valid = true;
+									}else
 										THROW_WEAK_ERROR(segments[0].type == Path::SegmentType::MOVE_TO ? "Path (move) is invalid" : "Path (line) is invalid");
 									break;
 								case Path::SegmentType::CURVE_TO:
-									if(path_stream >> segments[0].point.x &&
-										path_stream >> segments[0].point.y &&
-										path_stream >> segments[1].point.x &&
-										path_stream >> segments[1].point.y &&
-										path_stream >> segments[2].point.x &&
-										path_stream >> segments[2].point.y){
+									if(stdex::string_to_number(path_token, segments[0].point.x) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[0].point.y) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[1].point.x) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[1].point.y) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[2].point.x) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[2].point.y)){
 										path.push_back(segments[0]);
 										path.push_back(segments[1]);
 										path.push_back(segments[2]);
+										segment_valid = true;
 									}else
 										THROW_WEAK_ERROR("Path (curve) is invalid");
 									break;
 								case Path::SegmentType::ARC_TO:
-									if(path_stream >> segments[0].point.x &&
-										path_stream >> segments[0].point.y &&
-										path_stream >> segments[1].angle){
+									if(stdex::string_to_number(path_token, segments[0].point.x) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[0].point.y) &&
+										next_word(geometry, path_token) && stdex::string_to_number(path_token, segments[1].angle)){
 										path.push_back(segments[0]);
 										path.push_back(segments[1]);
+										segment_valid = true;
 									}else
 										THROW_WEAK_ERROR("Path (arc) is invalid");
 									break;
@@ -210,39 +245,48 @@ namespace SSB{
 									THROW_WEAK_ERROR("Path (close) is invalid");
 									break;
 							}
+							// Stop collection on invalid data
+							if(!segment_valid)
+								break;
 						}
 					// Successful collection of segments
 					ADD_OBJECT(Path(path));
 				}
 				break;
 			case Geometry::Type::TEXT:{
-					// Replace in string \t to 4 spaces
-					stdex::string_replace(geometry, "\t", "    ");
-					// Replace in string \n to real line breaks
-					stdex::string_replace(geometry, "\\n", "\n");
-					// Replace in string \{ to single {
-					stdex::string_replace(geometry, "\\{", "{");
+					// Unescape text: \t to 4 spaces, \n to real line breaks, \{ to single {
+					std::string text;
+					text.reserve(geometry.length());
+					for(auto it = geometry.begin(), it_end = geometry.end(); it != it_end; ++it)
+						if(*it == '\t')
+							text.append(4, ' ');
+						else if(*it == '\\' && it+1 != it_end && (*(it+1) == 'n' || *(it+1) == '{'))
+							text.push_back(*++it == 'n' ? '\n' : '{');
+						else
+							text.push_back(*it);
 					// Insert Text as Object to event
-					ADD_OBJECT(Text(geometry));
+					ADD_OBJECT(Text(text));
 				}
 				break;
 		}
 	}
 
-	void Parser::parse_tags(const std::string& tags, Geometry::Type& geometry_type, Event& event) throw(Exception){
-		// Stream for tags
-		std::istringstream tags_stream(tags);
-		// Registered tags + handler
-		static const std::vector<std::pair<std::string, std::function<void(std::string)>>> tags_register = {
-			{
-				"ff=",
-				[&event](std::string tag_values){
-					ADD_OBJECT(FontFamily(tag_values));
+	void Parser::parse_tags(stdex::string_view tags, Geometry::Type& geometry_type, Event& event) throw(Exception){
+		// Iterate through tags
+		stdex::string_view tags_token;
+		while(stdex::getline(tags, tags_token, ';')){
+			// Split tag into name & values
+			const auto name_end = tags_token.find('=');
+			const stdex::string_view tag_name = name_end != stdex::string_view::npos ? tags_token.substr(0, name_end) : stdex::string_view();
+			stdex::string_view tag_values = name_end != stdex::string_view::npos ? tags_token.substr(name_end+1) : stdex::string_view();
+			// Dispatch by perfect hash of tag name (collisions would be duplicated case labels), handled tags continue with next one
+			#define TAG_CASE(name) case tag_hash(name): if(tag_name != name) break;
+			switch(tag_hash(tag_name.data(), tag_name.length())){
+				TAG_CASE("ff"){
+					ADD_OBJECT(FontFamily(std::string(tag_values)));
 				}
-			},
-			{
-				"fst=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fst"){
 					bool bold = false, italic = false, underline = false, strikeout = false;
 					for(char c : tag_values)
 						if(c == 'b' && !bold)
@@ -257,63 +301,51 @@ namespace SSB{
 							THROW_WEAK_ERROR("Invalid font style");
 					ADD_OBJECT(FontStyle(bold, italic, underline, strikeout));
 				}
-			},
-			{
-				"fs=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fs"){
 					decltype(FontSize::size) size;
 					if(stdex::string_to_number(tag_values, size) && size >= 0)
 						ADD_OBJECT(FontSize(size));
 					else
 						THROW_WEAK_ERROR("Invalid font size");
 				}
-			},
-			{
-				"fsp=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fsp"){
 					decltype(FontSpace::x) x, y;
 					if(stdex::string_to_number(tag_values, x, y))
 						ADD_OBJECT(FontSpace(x, y));
 					else
 						THROW_WEAK_ERROR("Invalid font spaces");
 				}
-			},
-			{
-				"fsph=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fsph"){
 					decltype(FontSpace::x) x;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(FontSpace(FontSpace::Type::HORIZONTAL, x));
 					else
 						THROW_WEAK_ERROR("Invalid horizontal font space");
 				}
-			},
-			{
-				"fspv=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fspv"){
 					decltype(FontSpace::y) y;
 					if(stdex::string_to_number(tag_values, y))
 						ADD_OBJECT(FontSpace(FontSpace::Type::VERTICAL, y));
 					else
 						THROW_WEAK_ERROR("Invalid vertical font space");
 				}
-			},
-			{
-				"lw=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("lw"){
 					decltype(LineWidth::width) width;
 					if(stdex::string_to_number(tag_values, width) && width >= 0)
 						ADD_OBJECT(LineWidth(width));
 					else
 						THROW_WEAK_ERROR("Invalid line width");
 				}
-			},
-			{
-				"lst=",
-				[&event,this](std::string tag_values){
-					std::string::size_type pos;
-					if((pos = tag_values.find(',')) != std::string::npos){
-						std::string join_string = tag_values.substr(0, pos), cap_string = tag_values.substr(pos+1);
+				continue;
+				TAG_CASE("lst"){
+					stdex::string_view::size_type pos;
+					if((pos = tag_values.find(',')) != stdex::string_view::npos){
+						stdex::string_view join_string = tag_values.substr(0, pos), cap_string = tag_values.substr(pos+1);
 						LineStyle::Join join = LineStyle::Join::ROUND;
 						if(join_string == "r")
 							join = LineStyle::Join::ROUND;
@@ -332,17 +364,14 @@ namespace SSB{
 					}else
 						THROW_WEAK_ERROR("Invalid line style");
 				}
-			},
-			{
-				"ld=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("ld"){
 					decltype(LineDash::offset) offset;
-					std::istringstream dash_stream(tag_values);
-					std::string dash_token;
-					if(std::getline(dash_stream, dash_token, ',') && stdex::string_to_number(dash_token, offset) && offset >= 0){
+					stdex::string_view dash_token;
+					if(stdex::getline(tag_values, dash_token, ',') && stdex::string_to_number(dash_token, offset) && offset >= 0){
 						decltype(LineDash::dashes) dashes;
 						decltype(LineDash::offset) dash;
-						while(std::getline(dash_stream, dash_token, ','))
+						while(stdex::getline(tag_values, dash_token, ','))
 							if(stdex::string_to_number(dash_token, dash) && dash >= 0)
 								dashes.push_back(dash);
 							else
@@ -354,10 +383,8 @@ namespace SSB{
 					}else
 						THROW_WEAK_ERROR("Invalid line dashes");
 				}
-			},
-			{
-				"gm=",
-				[&event,this,&geometry_type](std::string tag_values){
+				continue;
+				TAG_CASE("gm"){
 					if(tag_values == "pt")
 						geometry_type = Geometry::Type::POINTS;
 					else if(tag_values == "p")
@@ -367,10 +394,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid geometry");
 				}
-			},
-			{
-				"md=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("md"){
 					if(tag_values == "f")
 						ADD_OBJECT(Mode(Mode::Method::FILL));
 					else if(tag_values == "w")
@@ -380,20 +405,16 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid mode");
 				}
-			},
-			{
-				"df=",
-				[&event,this](std::string tag_values){
-					std::string::size_type pos;
-					if((pos = tag_values.find(',')) != std::string::npos && tag_values.find(',', pos+1) == std::string::npos)
-						ADD_OBJECT(Deform(tag_values.substr(0, pos), tag_values.substr(pos+1)));
+				continue;
+				TAG_CASE("df"){
+					stdex::string_view::size_type pos;
+					if((pos = tag_values.find(',')) != stdex::string_view::npos && tag_values.find(',', pos+1) == stdex::string_view::npos)
+						ADD_OBJECT(Deform(std::string(tag_values.substr(0, pos)), std::string(tag_values.substr(pos+1))));
 					else
 						THROW_WEAK_ERROR("Invalid deform");
 				}
-			},
-			{
-				"pos=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("pos"){
 					decltype(Position::x) x, y;
 					constexpr decltype(x) max_pos = std::numeric_limits<decltype(x)>::max();
 					if(tag_values.empty())
@@ -403,19 +424,15 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid position");
 				}
-			},
-			{
-				"an=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("an"){
 					if(tag_values.length() == 1 && tag_values[0] >= '1' && tag_values[0] <= '9')
 						ADD_OBJECT(Align(static_cast<Align::Position>(tag_values[0] - '0')));
 					else
 						THROW_WEAK_ERROR("Invalid alignment");
 				}
-			},
-			{
-				"mg=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("mg"){
 					decltype(Margin::x) x, y;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(Margin(Margin::Type::BOTH, x));
@@ -424,30 +441,24 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid margin");
 				}
-			},
-			{
-				"mgh=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("mgh"){
 					decltype(Margin::x) x;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(Margin(Margin::Type::HORIZONTAL, x));
 					else
 						THROW_WEAK_ERROR("Invalid horizontal margin");
 				}
-			},
-			{
-				"mgv=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("mgv"){
 					decltype(Margin::y) y;
 					if(stdex::string_to_number(tag_values, y))
 						ADD_OBJECT(Margin(Margin::Type::VERTICAL, y));
 					else
 						THROW_WEAK_ERROR("Invalid vertical margin");
 				}
-			},
-			{
-				"dir=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("dir"){
 					if(tag_values == "ltr")
 						ADD_OBJECT(Direction(Direction::Mode::LTR));
 					else if(tag_values == "ttb")
@@ -455,40 +466,32 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid direction");
 				}
-			},
-			{
-				"tl=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("tl"){
 					decltype(Translate::x) x, y;
 					if(stdex::string_to_number(tag_values, x, y))
 						ADD_OBJECT(Translate(x, y));
 					else
 						THROW_WEAK_ERROR("Invalid translation");
 				}
-			},
-			{
-				"tlx=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("tlx"){
 					decltype(Translate::x) x;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(Translate(Translate::Type::HORIZONTAL, x));
 					else
 						THROW_WEAK_ERROR("Invalid horizontal translation");
 				}
-			},
-			{
-				"tly=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("tly"){
 					decltype(Translate::y) y;
 					if(stdex::string_to_number(tag_values, y))
 						ADD_OBJECT(Translate(Translate::Type::VERTICAL, y));
 					else
 						THROW_WEAK_ERROR("Invalid vertical translation");
 				}
-			},
-			{
-				"sc=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("sc"){
 					decltype(Scale::x) x, y;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(Scale(Scale::Type::BOTH, x));
@@ -497,115 +500,94 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid scale");
 				}
-			},
-			{
-				"scx=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("scx"){
 					decltype(Scale::x) x;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(Scale(Scale::Type::HORIZONTAL, x));
 					else
 						THROW_WEAK_ERROR("Invalid horizontal scale");
 				}
-			},
-			{
-				"scy=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("scy"){
 					decltype(Scale::y) y;
 					if(stdex::string_to_number(tag_values, y))
 						ADD_OBJECT(Scale(Scale::Type::VERTICAL, y));
 					else
 						THROW_WEAK_ERROR("Invalid vertical scale");
 				}
-			},
-			{
-				"rxy=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("rxy"){
 					decltype(Rotate::angle1) angle1, angle2;
 					if(stdex::string_to_number(tag_values, angle1, angle2))
 						ADD_OBJECT(Rotate(Rotate::Axis::XY, angle1, angle2));
 					else
 						THROW_WEAK_ERROR("Invalid rotation on x axis");
 				}
-			},
-			{
-				"ryx=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("ryx"){
 					decltype(Rotate::angle1) angle1, angle2;
 					if(stdex::string_to_number(tag_values, angle1, angle2))
 						ADD_OBJECT(Rotate(Rotate::Axis::YX, angle1, angle2));
 					else
 						THROW_WEAK_ERROR("Invalid rotation on y axis");
 				}
-			},
-			{
-				"rz=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("rz"){
 					decltype(Rotate::angle1) angle;
 					if(stdex::string_to_number(tag_values, angle))
 						ADD_OBJECT(Rotate(angle));
 					else
 						THROW_WEAK_ERROR("Invalid rotation on z axis");
 				}
-			},
-			{
-				"sh=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("sh"){
 					decltype(Shear::x) x, y;
 					if(stdex::string_to_number(tag_values, x, y))
 						ADD_OBJECT(Shear(x, y));
 					else
 						THROW_WEAK_ERROR("Invalid shear");
 				}
-			},
-			{
-				"shx=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("shx"){
 					decltype(Shear::x) x;
 					if(stdex::string_to_number(tag_values, x))
 						ADD_OBJECT(Shear(Shear::Type::HORIZONTAL, x));
 					else
 						THROW_WEAK_ERROR("Invalid horizontal shear");
 				}
-			},
-			{
-				"shy",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("shy"){
 					decltype(Shear::y) y;
 					if(stdex::string_to_number(tag_values, y))
 						ADD_OBJECT(Shear(Shear::Type::VERTICAL, y));
 					else
 						THROW_WEAK_ERROR("Invalid vertical shear");
 				}
-			},
-			{
-				"tf=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("tf"){
 					decltype(Transform::xx) xx, xy, xz, x0, yx, yy, yz, y0, zx, zy, zz, z0;
-					std::istringstream matrix_stream(tag_values);
-					std::string matrix_token;
-					if(std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, xx) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, xy) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, xz) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, x0) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, yx) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, yy) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, yz) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, y0) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, zx) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, zy) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, zz) &&
-							std::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, z0) &&
-							matrix_stream.eof()
+					stdex::string_view matrix_stream = tag_values, matrix_token;
+					if(stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, xx) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, xy) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, xz) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, x0) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, yx) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, yy) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, yz) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, y0) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, zx) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, zy) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, zz) &&
+							stdex::getline(matrix_stream, matrix_token, ',') && stdex::string_to_number(matrix_token, z0) &&
+							matrix_stream.empty() && tag_values.back() != ','
 						)
 						ADD_OBJECT(Transform(xx, xy, xz, x0, yx, yy, yz, y0, zx, zy, zz, z0));
 					else
 						THROW_WEAK_ERROR("Invalid transform");
 				}
-			},
-			{
-				"cl=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("cl"){
 					unsigned long rgb[4];
 					if(stdex::hex_string_to_number(tag_values, rgb[0]) &&
 						rgb[0] <= 0xffffff)
@@ -643,10 +625,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid color");
 				}
-			},
-			{
-				"lcl=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("lcl"){
 					unsigned long rgb;
 					if(stdex::hex_string_to_number(tag_values, rgb) &&
 							rgb <= 0xffffff)
@@ -658,10 +638,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid line color");
 				}
-			},
-			{
-				"al=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("al"){
 					unsigned short a[4];
 					if(stdex::hex_string_to_number(tag_values, a[0]) &&
 							a[0] <= 0xff)
@@ -683,10 +661,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid alpha");
 				}
-			},
-			{
-				"lal=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("lal"){
 					unsigned short a;
 					if(stdex::hex_string_to_number(tag_values, a) &&
 							a <= 0xff)
@@ -694,23 +670,19 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid line alpha");
 				}
-			},
-			{
-				"tex=",
-				[&event](std::string tag_values){
-					ADD_OBJECT(Texture(tag_values));
+				continue;
+				TAG_CASE("tex"){
+					ADD_OBJECT(Texture(std::string(tag_values)));
 				}
-			},
-			{
-				"texf=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("texf"){
 					decltype(TexFill::x) x, y;
-					std::string::size_type pos1, pos2;
-					if((pos1 = tag_values.find(',')) != std::string::npos &&
+					stdex::string_view::size_type pos1, pos2;
+					if((pos1 = tag_values.find(',')) != stdex::string_view::npos &&
 							stdex::string_to_number(tag_values.substr(0, pos1), x) &&
-							(pos2 = tag_values.find(',', pos1+1)) != std::string::npos &&
+							(pos2 = tag_values.find(',', pos1+1)) != stdex::string_view::npos &&
 							stdex::string_to_number(tag_values.substr(pos1+1, pos2-(pos1+1)), y)){
-						std::string wrap = tag_values.substr(pos2+1);
+						stdex::string_view wrap = tag_values.substr(pos2+1);
 						if(wrap == "c")
 							ADD_OBJECT(TexFill(x, y, TexFill::WrapStyle::CLAMP));
 						else if(wrap == "r")
@@ -724,10 +696,8 @@ namespace SSB{
 					}else
 						THROW_WEAK_ERROR("Invalid texture filling");
 				}
-			},
-			{
-				"bld=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("bld"){
 					if(tag_values == "over")
 						ADD_OBJECT(Blend(Blend::Mode::OVER));
 					else if(tag_values == "add")
@@ -743,10 +713,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid blending");
 				}
-			},
-			{
-				"bl=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("bl"){
 					decltype(Blur::x) x, y;
 					if(stdex::string_to_number(tag_values, x) && x >= 0)
 						ADD_OBJECT(Blur(Blur::Type::BOTH, x));
@@ -755,30 +723,24 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid blur");
 				}
-			},
-			{
-				"blh=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("blh"){
 					decltype(Blur::x) x;
 					if(stdex::string_to_number(tag_values, x) && x >= 0)
 						ADD_OBJECT(Blur(Blur::Type::HORIZONTAL, x));
 					else
 						THROW_WEAK_ERROR("Invalid horizontal blur");
 				}
-			},
-			{
-				"blv=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("blv"){
 					decltype(Blur::y) y;
 					if(stdex::string_to_number(tag_values, y) && y >= 0)
 						ADD_OBJECT(Blur(Blur::Type::VERTICAL, y));
 					else
 						THROW_WEAK_ERROR("Invalid vertical blur");
 				}
-			},
-			{
-				"stc=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("stc"){
 					if(tag_values == "off")
 						ADD_OBJECT(Stencil(Stencil::Mode::OFF));
 					else if(tag_values == "set")
@@ -792,10 +754,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid stencil mode");
 				}
-			},
-			{
-				"aa=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("aa"){
 					if(tag_values == "on")
 						ADD_OBJECT(AntiAliasing(true));
 					else if(tag_values == "off")
@@ -803,10 +763,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid anti-aliasing mode");
 				}
-			},
-			{
-				"fad=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fad"){
 					decltype(Fade::in) in, out;
 					if(stdex::string_to_number(tag_values, in))
 						ADD_OBJECT(Fade(Fade::Type::BOTH, in));
@@ -815,61 +773,53 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid fade");
 				}
-			},
-			{
-				"fadi=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fadi"){
 					decltype(Fade::in) in;
 					if(stdex::string_to_number(tag_values, in))
 						ADD_OBJECT(Fade(Fade::Type::INFADE, in));
 					else
 						THROW_WEAK_ERROR("Invalid infade");
 				}
-			},
-			{
-				"fado=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("fado"){
 					decltype(Fade::out) out;
 					if(stdex::string_to_number(tag_values, out))
 						ADD_OBJECT(Fade(Fade::Type::OUTFADE, out));
 					else
 						THROW_WEAK_ERROR("Invalid outfade");
 				}
-			},
-			{
-				"ani=",
-				[&event,this,&tags_stream,&geometry_type](std::string tag_values){
+				continue;
+				TAG_CASE("ani"){
 					// Collect animation tokens (maximum: 4)
-					std::vector<std::string> animate_tokens;
-					std::istringstream animate_stream(tag_values);
-					std::string animate_token;
-					for(unsigned char i = 0; std::getline(animate_stream, animate_token, ',') && i < 4; ++i)
+					stdex::string_view animate_tokens[4], animate_stream = tag_values, animate_token;
+					unsigned char animate_tokens_n = 0;
+					while(animate_tokens_n < 4 && stdex::getline(animate_stream, animate_token, ','))
 						// Get last token with brackets
 						if(!animate_token.empty() && animate_token.front() == '('){
 							// If animated tags contain ',' too, add the rest of animation
-							if(animate_stream.unget() && animate_stream.get() == ','){
-								std::string animate_rest;
-								std::getline(animate_stream, animate_rest);
-								animate_token += ',' + animate_rest;
-							}
-							// Extend animation stream to get all animated tags
-							while(animate_token.back() != ')' && std::getline(tags_stream, tag_values, ';'))
-								animate_token += ';' + tag_values;
-							animate_tokens.push_back(std::move(animate_token));
+							animate_token = tag_values.substr(animate_token.data() - tag_values.data());
+							// Extend animation token by following tags (in same memory) to get all animated tags
+							stdex::string_view next_tags_token;
+							while(animate_token.back() != ')' && stdex::getline(tags, next_tags_token, ';'))
+								animate_token = stdex::string_view(animate_token.data(), next_tags_token.end() - animate_token.data());
+							animate_tokens[animate_tokens_n++] = animate_token;
 							// Finish collecting after last possible token
 							break;
 						// Get first tokens (times & formula)
 						}else
-							animate_tokens.push_back(std::move(animate_token));
+							animate_tokens[animate_tokens_n++] = animate_token;
 					// Check for enough animation tokens and last token for brackets
-					if(animate_tokens.size() > 0 && animate_tokens.back().length() >= 2 && animate_tokens.back().front() == '(' && animate_tokens.back().back() == ')'){
+					if(animate_tokens_n > 0 && animate_tokens[animate_tokens_n-1].length() >= 2 && animate_tokens[animate_tokens_n-1].front() == '(' && animate_tokens[animate_tokens_n-1].back() == ')'){
 						// Get animation values
 						constexpr decltype(Animate::start) max_duration = std::numeric_limits<decltype(Animate::start)>::max();
 						decltype(Animate::start) start_time = max_duration, end_time = max_duration;
-						std::string progress_formula, tags;
-						Event buffer_event;
+						stdex::string_view progress_formula, tags;
+						// Animated objects get parsed into the same event (for arena memory) and moved from the objects list afterwards
+						const size_t objects_begin = event.objects.size();
+						const bool static_tags = event.static_tags;
 						try{
-							switch(animate_tokens.size()){
+							switch(animate_tokens_n){
 								case 1: tags = animate_tokens[0].substr(1, animate_tokens[0].size()-2);
 									break;
 								case 2: progress_formula = animate_tokens[0];
@@ -885,21 +835,23 @@ namespace SSB{
 									tags = animate_tokens[3].substr(1, animate_tokens[3].size()-2);
 									break;
 							}
-							this->parse_tags(tags, geometry_type, buffer_event);
-							if(!buffer_event.static_tags)
+							event.static_tags = true;
+							this->parse_tags(tags, geometry_type, event);
+							if(!event.static_tags)
 								throw std::string("No animations in animations allowed");
 							event.static_tags = false;
-							ADD_OBJECT(Animate(start_time, end_time, progress_formula, buffer_event.objects));
+							std::vector<Object*> animate_objects(event.objects.begin() + objects_begin, event.objects.end());
+							event.objects.resize(objects_begin);
+							ADD_OBJECT(Animate(start_time, end_time, std::string(progress_formula), std::move(animate_objects)));
 						}catch(std::string error_message){
+							event.objects.resize(objects_begin), event.static_tags = static_tags;
 							THROW_WEAK_ERROR("Animation values incorrect: " + error_message);
 						}
 					}else
 						THROW_WEAK_ERROR("Invalid animate");
 				}
-			},
-			{
-				"k=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("k"){
 					decltype(Karaoke::time) time;
 					if(stdex::string_to_number(tag_values, time)){
 						event.static_tags = false;
@@ -907,10 +859,8 @@ namespace SSB{
 					}else
 						THROW_WEAK_ERROR("Invalid karaoke");
 				}
-			},
-			{
-				"ks=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("ks"){
 					decltype(Karaoke::time) time;
 					if(stdex::string_to_number(tag_values, time)){
 						event.static_tags = false;
@@ -918,10 +868,8 @@ namespace SSB{
 					}else
 						THROW_WEAK_ERROR("Invalid karaoke set");
 				}
-			},
-			{
-				"kc=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("kc"){
 					unsigned long int rgb;
 					if(stdex::hex_string_to_number(tag_values, rgb) && rgb <= 0xffffff)
 						ADD_OBJECT(KaraokeColor(
@@ -932,10 +880,8 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid karaoke color");
 				}
-			},
-			{
-				"km=",
-				[&event,this](std::string tag_values){
+				continue;
+				TAG_CASE("km"){
 					if(tag_values == "f")
 						ADD_OBJECT(KaraokeMode(KaraokeMode::Mode::FILL));
 					else if(tag_values == "s")
@@ -945,59 +891,327 @@ namespace SSB{
 					else
 						THROW_WEAK_ERROR("Invalid karaoke mode");
 				}
+				continue;
 			}
-		};
-		// Iterate through tags
-		std::string tags_token;
-		while(std::getline(tags_stream, tags_token, ';')){
-			// Evaluate single tags
-			for(auto& tag_entry : tags_register)
-				if(tags_token.compare(0, tag_entry.first.length(), tag_entry.first) == 0){
-					tag_entry.second(tags_token.substr(tag_entry.first.length()));
-					goto TAG_FOUND;
-				}
-			THROW_WEAK_ERROR("Invalid tag \"" + tags_token + '\"');
-			TAG_FOUND:
-			continue;	// Statement expected after label
+			#undef TAG_CASE
+			THROW_WEAK_ERROR("Invalid tag \"" + std::string(tags_token) + '\"');
 		}
 	}
 
-	void Parser::parse_script(Data& data, std::istream& script) throw(Exception){
+	void Parser::parse_script(Data& data, const char* script, size_t script_size, unsigned long line_offset) throw(Exception){
+		// Load precompiled script without parsing
+		if(Serializer::is_binary(script, script_size)){
+			Serializer::read(data, script, script_size);
+			return;
+		}
+		stdex::string_view script_rest(script, script_size);
 		// Skip UTF-8 byte-order-mask
-		unsigned char BOM[3];
-		script.read(reinterpret_cast<char*>(BOM), 3);
-		if(!script.good())	// Reading BOM behind EOF shouldn't cause error flag
-			script.clear();
-		if(!(script.gcount() == 3 && BOM[0] == 0xef && BOM[1] == 0xbb && BOM[2] == 0xbf))
-			script.seekg(0);
+		if(STR_LIT_EQU_FIRST(script_rest, "\xef\xbb\xbf"))
+			script_rest.remove_prefix(3);
 		// Line number for advanced error message
-		unsigned long line_number = 0;
-		// Line input buffer
-		std::string line;
+		unsigned long line_number = line_offset;
+		// Line view into script memory
+		stdex::string_view line;
+		// Event lines to parse in parallel (collected until anything else changes parsing state)
+		std::vector<std::pair<unsigned long, stdex::string_view>> event_lines;
 		// Catch error in actual parsing
 		try{
-			// Iterate through stream lines
-			while(std::getline(script, line)){
+			// Iterate through script lines
+			while(stdex::getline(script_rest, line, '\n')){
 				// Remove carriage return in case of CRLF ending
 				if(!line.empty() && line.back() == '\r')
-					line.pop_back();
-				// Update line number to current stream
+					line.remove_suffix(1);
+				// Update line number to current script position
 				line_number++;
-				// Parse the current stream line
-				this->parse_line(data, line);
+				// Skip empty & comment lines
+				if(line.empty() || STR_LIT_EQU_FIRST(line, "//"))
+					continue;
+				// Collect event line for parallel parsing
+				if(this->threads != 1 && this->content != Content::INDEX && data.current_section == Data::Section::EVENTS && line.front() != '#')
+					event_lines.emplace_back(line_number, line);
+				// Parse the current script line (after collected events)
+				else{
+					if(!event_lines.empty())
+						this->parse_events(data, event_lines, line_number),
+						event_lines.clear();
+					this->parse_line(data, line);
+				}
 			}
+			// Parse remaining events
+			if(!event_lines.empty())
+				this->parse_events(data, event_lines, line_number);
 		}catch(Exception e){
 			// Rethrow error message with additional line number
 			throw Exception(std::to_string(line_number) + ": " + e.what());
 		}
 	}
 
-	void Parser::parse_line(Data& data, const std::string& line) throw(Exception){
+	void Parser::parse_events(Data& data, const std::vector<std::pair<unsigned long, stdex::string_view>>& event_lines, unsigned long& line_number) throw(Exception){
+		// Split lines into one chunk per thread (with a minimum of lines to be worth a thread)
+		constexpr unsigned long min_chunk_lines = 256;
+		const unsigned chunks_n = std::max(1UL, std::min<unsigned long>(this->threads ? this->threads : stdex::hardware_concurrency(), event_lines.size() / min_chunk_lines));
+		struct Chunk{
+			std::vector<Event> events;
+			unsigned long error_line = 0;
+			std::string error_message;
+		};
+		std::vector<Chunk> chunks(chunks_n);
+		// Pre-parse styles before threads share the cache
+		for(const std::pair<const std::string, std::string>& style : data.styles)
+			this->intern_style(style.second);
+		// Parse chunk until first error
+		auto parse_chunk = [&](const unsigned chunk_i){
+			Chunk& chunk = chunks[chunk_i];
+			const size_t first = event_lines.size() * chunk_i / chunks_n,
+				last = event_lines.size() * (chunk_i + 1) / chunks_n;
+			chunk.events.reserve(last - first);
+			for(size_t i = first; i < last; ++i){
+				Event event;
+				try{
+					if(this->parse_event(data, event_lines[i].second, event, false))
+						chunk.events.push_back(std::move(event));
+				}catch(Exception e){
+					chunk.error_line = event_lines[i].first,
+					chunk.error_message = e.what();
+					break;
+				}
+			}
+		};
+		// Run chunks on worker threads & this one
+		std::vector<std::thread> workers;
+		workers.reserve(chunks_n - 1);
+		for(unsigned chunk_i = 1; chunk_i < chunks_n; ++chunk_i)
+			workers.emplace_back(parse_chunk, chunk_i);
+		parse_chunk(0);
+		for(std::thread& worker : workers)
+			worker.join();
+		// Commit events in script order up to first error
+		data.events.reserve(data.events.size() + event_lines.size());
+		for(Chunk& chunk : chunks){
+			std::move(chunk.events.begin(), chunk.events.end(), std::back_inserter(data.events));
+			if(chunk.error_line){
+				line_number = chunk.error_line;
+				throw Exception(chunk.error_message);
+			}
+		}
+	}
+
+	void Parser::parse_script(Data& data, std::istream& script) throw(Exception){
+		// Indexed lines would point into temporary memory
+		if(this->content == Content::INDEX)
+			throw Exception("Can't index script stream");
+		// Read whole stream into memory
+		std::string buffer;
+		char chunk[4096];
+		while(script.read(chunk, sizeof(chunk)) || script.gcount() > 0)
+			buffer.append(chunk, script.gcount());
+		// Parse script from memory
+		this->parse_script(data, buffer.data(), buffer.size());
+	}
+
+	bool Parser::parse_event(const Data& data, stdex::string_view line, Event& event) throw(Exception){
+		return this->parse_event(data, line, event, true);
+	}
+
+	bool Parser::parse_event(const Data& data, stdex::string_view line, Event& event, bool intern_styles) throw(Exception){
+		// Extract times, style & text
+		const std::string* style_content;
+		stdex::string_view text;
+		if(!this->parse_event_header(data, line, event, style_content, text))
+			return false;
+		// Keep script line
+		if(this->content != Content::PARSED)
+			event.source = std::string(line);
+		// Postpone objects parsing
+		if(this->content == Content::LAZY)
+			event.parsed = false;
+		else
+			this->parse_event_content(data, style_content, text, event, intern_styles);
+		return true;
+	}
+
+	void Parser::complete_event(const Data& data, Event& event) throw(Exception){
+		if(!event.parsed){
+			// Invalid event becomes inactive (counts as parsed, so isn't tried again) but keeps its line & styles
+			auto deactivate = [&event]{
+				std::string source = std::move(event.source);
+				std::vector<std::string> style_names = std::move(event.style_names);
+				event = Event(),
+				event.source = std::move(source),
+				event.style_names = std::move(style_names);
+			};
+			const std::string* style_content;
+			stdex::string_view text;
+			try{
+				if(this->parse_event_header(data, event.source, event, style_content, text))
+					this->parse_event_content(data, style_content, text, event, true),
+					event.parsed = true;
+				else
+					deactivate();
+			}catch(Exception){
+				deactivate();
+				throw;
+			}
+		}
+	}
+
+	void Parser::intern_style(const std::string& style_content){
+		if(this->styles_cache.find(style_content) == this->styles_cache.end()){
+			// Limit memory of outdated styles (events keep their own references)
+			if(this->styles_cache.size() >= 1024)
+				this->styles_cache.clear();
+			// Styles of just tags (no inline styles) can be parsed once
+			std::shared_ptr<Event> style_event;
+			Geometry::Type geometry_type = Geometry::Type::TEXT;
+			if(!style_content.empty() && style_content.front() == '{' && style_content.back() == '}' && style_content.find("\\\\") == std::string::npos){
+				style_event = std::make_shared<Event>();
+				stdex::string_view tags_rest(style_content), tags;
+				try{
+					while(!tags_rest.empty()){
+						const stdex::string_view::size_type tags_end = tags_rest.find('}');
+						if(tags_rest.front() != '{' || tags_end == stdex::string_view::npos){
+							style_event.reset();
+							break;
+						}
+						tags = tags_rest.substr(1, tags_end - 1),
+						tags_rest.remove_prefix(tags_end + 1);
+						if(!tags.empty())
+							this->parse_tags(tags, geometry_type, *style_event);
+					}
+				}catch(Exception){
+					// Let event parsing report the error at its line
+					style_event.reset();
+				}
+			}
+			this->styles_cache.emplace(style_content, std::make_pair(std::move(style_event), geometry_type));
+		}
+	}
+
+	bool Parser::parse_event_header(const Data& data, stdex::string_view line, Event& event, const std::string*& style_content, stdex::string_view& text) throw(Exception){
+		// Prepare line tokenization
+		stdex::string_view line_rest = line, line_token;
+		// Extract start time
+		if(!stdex::getline(line_rest, line_token, '-') || !parse_time(line_token, event.start_ms)){
+			THROW_STRONG_ERROR("Couldn't find start time");
+			return false;
+		}
+		// Extract end time
+		if(!stdex::getline(line_rest, line_token, '|') || !parse_time(line_token, event.end_ms)){
+			THROW_STRONG_ERROR("Couldn't find end time");
+			return false;
+		}
+		// Check valid times
+		if(event.start_ms > event.end_ms){
+			THROW_WEAK_ERROR("Start time mustn't be after end time");
+			return false;
+		}
+		// Extract style name
+		if(!stdex::getline(line_rest, line_token, '|')){
+			THROW_STRONG_ERROR("Couldn't find style");
+			return false;
+		}
+		// Remember style for reparsing (even unknown one, it could be added later)
+		if(this->content != Content::PARSED){
+			event.style_names.clear();
+			if(!line_token.empty())
+				event.style_names.emplace_back(line_token);
+		}
+		// Get style content for later insertion
+		style_content = nullptr;
+		auto style = data.styles.find(std::string(line_token));
+		if(style != data.styles.end())
+			style_content = &style->second;
+		else if(!line_token.empty()){
+			THROW_WEAK_ERROR("Couldn't find style");
+			return false;
+		}
+		// Skip note
+		if(!stdex::getline(line_rest, line_token, '|')){
+			THROW_STRONG_ERROR("Couldn't find note");
+			return false;
+		}
+		// Extract text
+		if(line_token.end() == line.end() || *line_token.end() != '|'){
+			THROW_STRONG_ERROR("Couldn't find text");
+			return false;
+		}
+		text = line_rest;
+		return true;
+	}
+
+	void Parser::parse_event_content(const Data& data, const std::string* style_content, stdex::string_view text, Event& event, bool intern_styles) throw(Exception){
+		// Take objects of pre-parsed style
+		Geometry::Type geometry_type = Geometry::Type::TEXT;
+		if(style_content && !style_content->empty()){
+			if(intern_styles)
+				this->intern_style(*style_content);
+			auto style = this->styles_cache.find(*style_content);
+			if(style != this->styles_cache.end() && style->second.first)
+				event.style = style->second.first,
+				event.objects.insert(event.objects.end(), event.style->objects.begin(), event.style->objects.end()),
+				event.static_tags = event.style->static_tags,
+				geometry_type = style->second.second,
+				style_content = nullptr;
+		}
+		// Use text in line memory if no style insertions are necessary, otherwise build new one
+		std::string text_buffer;
+		if((style_content && !style_content->empty()) || text.find("\\\\") != stdex::string_view::npos){
+			text_buffer = style_content ? *style_content + std::string(text) : std::string(text);
+			// Add inline styles to text
+			unsigned inline_count = MAX_INLINE_STYLES;
+			std::string::size_type pos_start = 0, pos_end;
+			while(inline_count && (pos_start = text_buffer.find("\\\\", pos_start)) != std::string::npos && (pos_end = text_buffer.find("\\\\", pos_start+2)) != std::string::npos){
+				const std::string macro_name = text_buffer.substr(pos_start + 2, pos_end - (pos_start + 2));
+				if(this->content != Content::PARSED && std::find(event.style_names.begin(), event.style_names.end(), macro_name) == event.style_names.end())
+					event.style_names.push_back(macro_name);
+				auto macro = data.styles.find(macro_name);
+				if(macro != data.styles.end()){
+					text_buffer.replace(pos_start, macro->first.length()+4, macro->second);
+					inline_count--;
+				}else
+					pos_start = pos_end + 2;
+			}
+			text = text_buffer;
+		}
+		// Evaluate text tokens
+		bool in_tags = false;
+		stdex::string_view::size_type pos_start = 0, pos_end;
+		do{
+			// Evaluate tags
+			if(in_tags){
+				// Search tags end at closing bracket or cause error
+				pos_end = text.find('}', pos_start);
+				if(pos_end == stdex::string_view::npos){
+					THROW_WEAK_ERROR("Tags closing brace not found");
+					break;
+				}
+				// Parse single tags
+				stdex::string_view tags = text.substr(pos_start, pos_end - pos_start);
+				if(!tags.empty())
+					this->parse_tags(tags, geometry_type, event);
+			// Evaluate geometries
+			}else{
+				// Search geometry end at tags bracket (unescaped) or text end
+				pos_end = stdex::find_non_escaped_character(text, '{', pos_start);
+				if(pos_end == stdex::string_view::npos)
+					pos_end = text.length();
+				// Parse geometry by type
+				stdex::string_view geometry = text.substr(pos_start, pos_end - pos_start);
+				if(!geometry.empty())
+					this->parse_geometry(geometry, geometry_type, event);
+			}
+			// Update for next token
+			pos_start = pos_end + 1;
+			in_tags = !in_tags;
+		}while(pos_start < text.length());
+	}
+
+	void Parser::parse_line(Data& data, stdex::string_view line) throw(Exception){
 		// No empty or comment line = no skip
 		if(!line.empty() && !STR_LIT_EQU_FIRST(line, "//")){
 			// Section header line
 			if(line.front() == '#'){
-				std::string section = line.substr(1);
+				stdex::string_view section = line.substr(1);
 				if(section == "META")
 					data.current_section = Data::Section::META;
 				else if(section == "FRAME")
@@ -1012,13 +1226,13 @@ namespace SSB{
 				switch(data.current_section){
 					case Data::Section::META:
 						if(STR_LIT_EQU_FIRST(line, "Title: "))
-							data.meta.title = line.substr(7);
+							data.meta.title = std::string(line.substr(7));
 						else if(STR_LIT_EQU_FIRST(line, "Author: "))
-							data.meta.author = line.substr(8);
+							data.meta.author = std::string(line.substr(8));
 						else if(STR_LIT_EQU_FIRST(line, "Description: "))
-							data.meta.description = line.substr(13);
+							data.meta.description = std::string(line.substr(13));
 						else if(STR_LIT_EQU_FIRST(line, "Version: "))
-							data.meta.version = line.substr(9);
+							data.meta.version = std::string(line.substr(9));
 						else
 							THROW_STRONG_ERROR("Invalid meta field");
 						break;
@@ -1029,7 +1243,7 @@ namespace SSB{
 								data.frame.width = width;
 							else
 								THROW_WEAK_ERROR("Invalid frame width");
-						}else if(STR_LIT_EQU_FIRST(line, "Heigth: ")){
+						}else if(STR_LIT_EQU_FIRST(line, "Height: ")){
 							decltype(data.frame.height) height;
 							if(stdex::string_to_number(line.substr(8), height))
 								data.frame.height = height;
@@ -1040,101 +1254,23 @@ namespace SSB{
 						break;
 					case Data::Section::STYLES:{
 							auto split_pos = line.find(": ");
-							if(split_pos != std::string::npos)
-								data.styles[line.substr(0, split_pos)] = line.substr(split_pos+2);
+							if(split_pos != stdex::string_view::npos)
+								data.styles[std::string(line.substr(0, split_pos))] = std::string(line.substr(split_pos+2));
 							else
 								THROW_STRONG_ERROR("Invalid styles field");
 						}
 						break;
 					case Data::Section::EVENTS:{
-							// Temporary event buffer
 							Event event;
-							// Prepare line tokenization
-							std::istringstream line_stream(line);
-							std::string line_token;
-							// Extract start time
-							if(!std::getline(line_stream, line_token, '-') || !parse_time(line_token, event.start_ms)){
-								THROW_STRONG_ERROR("Couldn't find start time");
-								break;
-							}
-							// Extract end time
-							if(!std::getline(line_stream, line_token, '|') || !parse_time(line_token, event.end_ms)){
-								THROW_STRONG_ERROR("Couldn't find end time");
-								break;
-							}
-							// Check valid times
-							if(event.start_ms > event.end_ms){
-								THROW_WEAK_ERROR("Start time mustn't be after end time");
-								break;
-							}
-							// Extract style name
-							if(!std::getline(line_stream, line_token, '|')){
-								THROW_STRONG_ERROR("Couldn't find style");
-								break;
-							}
-							// Get style content for later insertion
-							std::string style_content;
-							if(!line_token.empty() && !data.styles.count(line_token)){
-								THROW_WEAK_ERROR("Couldn't find style");
-								break;
-							}else
-								style_content = data.styles[line_token];
-							// Skip note
-							if(!std::getline(line_stream, line_token, '|')){
-								THROW_STRONG_ERROR("Couldn't find note");
-								break;
-							}
-							// Extract text
-							if(!line_stream.unget() || line_stream.get() != '|'){
-								THROW_STRONG_ERROR("Couldn't find text");
-								break;
-							}
-							std::string text = std::getline(line_stream, line_token) ? style_content + line_token : style_content;
-							// Add inline styles to text
-							unsigned inline_count = MAX_INLINE_STYLES;
-							std::string::size_type pos_start = 0, pos_end;
-							while(inline_count && (pos_start = text.find("\\\\", pos_start)) != std::string::npos && (pos_end = text.find("\\\\", pos_start+2)) != std::string::npos){
-								std::string macro = text.substr(pos_start + 2, pos_end - (pos_start + 2));
-								if(data.styles.count(macro)){
-									text.replace(pos_start, macro.length()+4, data.styles[macro]);
-									inline_count--;
-								}else
-									pos_start = pos_end + 2;
-							}
-							// Evaluate text tokens
-							Geometry::Type geometry_type = Geometry::Type::TEXT;
-							bool in_tags = false;
-							pos_start = 0;
-							do{
-								// Evaluate tags
-								if(in_tags){
-									// Search tags end at closing bracket or cause error
-									pos_end = text.find('}', pos_start);
-									if(pos_end == std::string::npos){
-										THROW_WEAK_ERROR("Tags closing brace not found");
-										break;
-									}
-									// Parse single tags
-									std::string tags = text.substr(pos_start, pos_end - pos_start);
-									if(!tags.empty())
-										this->parse_tags(tags, geometry_type, event);
-								// Evaluate geometries
-								}else{
-									// Search geometry end at tags bracket (unescaped) or text end
-									pos_end = stdex::find_non_escaped_character(text, '{', pos_start);
-									if(pos_end == std::string::npos)
-										pos_end = text.length();
-									// Parse geometry by type
-									std::string geometry = text.substr(pos_start, pos_end - pos_start);
-									if(!geometry.empty())
-										this->parse_geometry(geometry, geometry_type, event);
-								}
-								// Update for next token
-								pos_start = pos_end + 1;
-								in_tags = !in_tags;
-							}while(pos_start < text.length());
-							// Event complete -> commit to data
-							data.events.push_back(std::move(event));
+							// Index event line by time range
+							if(this->content == Content::INDEX){
+								const std::string* style_content;
+								stdex::string_view text;
+								if(this->parse_event_header(data, line, event, style_content, text))
+									data.event_lines.push_back({event.start_ms, event.end_ms, line.data(), line.size()});
+							// Parse event and commit to data
+							}else if(this->parse_event(data, line, event))
+								data.events.push_back(std::move(event));
 						}
 						break;
 					case Data::Section::NONE:
@@ -15,6 +15,8 @@ Permission is granted to anyone to use this software for any purpose, including
 #pragma once
 
 #include "SSBData.hpp"
+#include "../utils/string.hpp"
+#include <unordered_map>
 
 namespace SSB{
 	// Subtilte parser to fill data containers
@@ -22,15 +24,35 @@ namespace SSB{
 		public:
 			// Level of error detection (0=OFF, 1=SYNTAX, 3=+VALUES)
 			enum class Level{OFF, SYNTAX, ALL} const level;
+			// Number of threads for parsing events of scripts (0=hardware concurrency)
+			const unsigned threads;
+			// Event content handling (PARSED=objects, SOURCE=objects+script line for reparsing, LAZY=script line, objects parsed on demand,
+			// INDEX=just event lines with time ranges, pointing into script memory which has to stay valid)
+			enum class Content{PARSED, SOURCE, LAZY, INDEX} const content;
 		private:
+			// Pre-parsed styles by content (no event if style needs textual insertion) with resulting geometry type
+			std::unordered_map<std::string, std::pair<std::shared_ptr<Event>, Geometry::Type>> styles_cache;
+			void intern_style(const std::string& style_content);
 			// Parse event elements
-			void parse_geometry(std::string geometry, Geometry::Type geometry_type, Event& event) throw(Exception);
-			void parse_tags(const std::string& tags, Geometry::Type& geometry_type, Event& event) throw(Exception);
+			void parse_geometry(stdex::string_view geometry, Geometry::Type geometry_type, Event& event) throw(Exception);
+			void parse_tags(stdex::string_view tags, Geometry::Type& geometry_type, Event& event) throw(Exception);
+			bool parse_event_header(const Data& data, stdex::string_view line, Event& event, const std::string*& style_content, stdex::string_view& text) throw(Exception);
+			void parse_event_content(const Data& data, const std::string* style_content, stdex::string_view text, Event& event, bool intern_styles) throw(Exception);
+			bool parse_event(const Data& data, stdex::string_view line, Event& event, bool intern_styles) throw(Exception);
+			// Parse a block of event lines (with their line numbers) on multiple threads
+			void parse_events(Data& data, const std::vector<std::pair<unsigned long, stdex::string_view>>& event_lines, unsigned long& line_number) throw(Exception);
 		public:
 			// Constructor
-			Parser(Level level = Level::ALL) : level(level){};
+			Parser(Level level = Level::ALL, unsigned threads = 1, Content content = Content::PARSED) : level(level), threads(threads), content(content){};
+			// Parse one event line (false if event was invalid)
+			bool parse_event(const Data& data, stdex::string_view line, Event& event) throw(Exception);
+			// Parse objects of lazy event from its script line (invalid event becomes inactive; interns its style into shared cache,
+			// so calls on one parser have to be serialized, like by Renderer's load mutex)
+			void complete_event(const Data& data, Event& event) throw(Exception);
 			// Parse one text line
-			void parse_line(Data& data, const std::string& line) throw(Exception);
+			void parse_line(Data& data, stdex::string_view line) throw(Exception);
+			// Parse a whole script from memory (or load a precompiled one, see Serializer), optionally as part after given number of lines
+			void parse_script(Data& data, const char* script, size_t script_size, unsigned long line_offset = 0) throw(Exception);
 			// Parse a whole script from stream
 			void parse_script(Data& data, std::istream& script) throw(Exception);
 	};
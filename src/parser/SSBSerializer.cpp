@@ -0,0 +1,573 @@
+/*
+Project: SSBRenderer
+File: SSBSerializer.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "SSBSerializer.hpp"
+#include <cstring>
+#include <type_traits>
+
+// Binary script layout (native byte order, fixed-width values):
+//   header: magic[8], uint32 version, uint32 byte order mark
+//   meta: 4 strings, frame: 2 uint32, styles: uint32 count + name/content strings
+//   events: uint64 count + (uint64 start, uint64 end, uint8 static tags, objects)
+//   objects: uint32 count + (uint8 object type, uint8 tag/geometry type, values)
+//   strings & arrays: uint32 count + elements
+static constexpr char binary_magic[8] = {'\x89', 'S', 'S', 'B', '\r', '\n', '\x1a', '\n'};
+static constexpr uint32_t binary_byte_order = 0x01020304;
+
+namespace SSB{
+	// Output of fixed-width values
+	class BinaryWriter{
+		private:
+			std::ostream& out;
+		public:
+			BinaryWriter(std::ostream& out) : out(out){}
+			template<typename T>
+			void write(const T& value){
+				static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Just numbers & enumerations writable!");
+				this->out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+			}
+			void write_count(size_t count) throw(Exception){
+				if(count > 0xffffffff)
+					throw Exception("Too many elements for binary script");
+				this->write(static_cast<uint32_t>(count));
+			}
+			void write(const std::string& s) throw(Exception){
+				this->write_count(s.size()),
+				this->out.write(s.data(), s.size());
+			}
+			void write(const RGB& color){
+				this->write(color.r), this->write(color.g), this->write(color.b);
+			}
+	};
+
+	// Bounds-checked input of fixed-width values
+	class BinaryReader{
+		private:
+			const char* pos, *const end;
+			void check(size_t size) throw(Exception){
+				if(static_cast<size_t>(this->end - this->pos) < size)
+					throw Exception("Binary script is truncated");
+			}
+		public:
+			BinaryReader(const char* data, size_t data_size) : pos(data), end(data + data_size){}
+			template<typename T>
+			T read() throw(Exception){
+				static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Just numbers & enumerations readable!");
+				T value;
+				this->check(sizeof(value)),
+				std::memcpy(&value, this->pos, sizeof(value)),
+				this->pos += sizeof(value);
+				return value;
+			}
+			// Enumeration with value range check
+			template<typename T>
+			T read_enum(T last) throw(Exception){
+				const T value = this->read<T>();
+				if(static_cast<unsigned char>(value) > static_cast<unsigned char>(last))
+					throw Exception("Binary script contains invalid value");
+				return value;
+			}
+			// Count of elements with at least element_size bytes each (has to fit into remaining input)
+			size_t read_count(size_t element_size = 1) throw(Exception){
+				const size_t count = this->read<uint32_t>();
+				if(count > static_cast<size_t>(this->end - this->pos) / element_size)
+					throw Exception("Binary script is truncated");
+				return count;
+			}
+			std::string read_string() throw(Exception){
+				const size_t size = this->read_count();
+				this->check(size);
+				std::string s(this->pos, size);
+				this->pos += size;
+				return s;
+			}
+			RGB read_rgb() throw(Exception){
+				const Depth r = this->read<Depth>(), g = this->read<Depth>(), b = this->read<Depth>();
+				return {r, g, b};
+			}
+			bool read_bool() throw(Exception){
+				return this->read<uint8_t>() != 0;
+			}
+			const char* position() const{return this->pos;}
+	};
+}	// namespace SSB
+
+// Tags with horizontal, vertical or both values
+template<typename T>
+static inline void write_xy(SSB::BinaryWriter& writer, const T* tag){
+	writer.write(tag->type);
+	if(tag->type != T::Type::VERTICAL)
+		writer.write(static_cast<SSB::Coord>(tag->x));
+	if(tag->type != T::Type::HORIZONTAL)
+		writer.write(static_cast<SSB::Coord>(tag->y));
+}
+template<typename T>
+static inline T* read_xy(SSB::BinaryReader& reader, SSB::Event& event){
+	const typename T::Type type = reader.read_enum(T::Type::BOTH);
+	if(type == T::Type::BOTH){
+		const SSB::Coord x = reader.read<SSB::Coord>(), y = reader.read<SSB::Coord>();
+		return new(event.arena) T(x, y);
+	}
+	return new(event.arena) T(type, reader.read<SSB::Coord>());
+}
+
+// Objects (recursive for animations)
+static void write_objects(SSB::BinaryWriter& writer, const std::vector<SSB::Object*>& objects){
+	using namespace SSB;
+	writer.write_count(objects.size());
+	for(const Object* object : objects){
+		writer.write(object->type);
+		if(object->type == Object::Type::TAG){
+			const Tag* tag = static_cast<const Tag*>(object);
+			writer.write(tag->type);
+			switch(tag->type){
+				case Tag::Type::FONT_FAMILY:
+					writer.write(static_cast<const FontFamily*>(tag)->family);
+					break;
+				case Tag::Type::FONT_STYLE:{
+						const FontStyle* style = static_cast<const FontStyle*>(tag);
+						writer.write<uint8_t>(style->bold), writer.write<uint8_t>(style->italic), writer.write<uint8_t>(style->underline), writer.write<uint8_t>(style->strikeout);
+					}
+					break;
+				case Tag::Type::FONT_SIZE:
+					writer.write(static_cast<const FontSize*>(tag)->size);
+					break;
+				case Tag::Type::FONT_SPACE:
+					write_xy(writer, static_cast<const FontSpace*>(tag));
+					break;
+				case Tag::Type::LINE_WIDTH:
+					writer.write(static_cast<const LineWidth*>(tag)->width);
+					break;
+				case Tag::Type::LINE_STYLE:{
+						const LineStyle* style = static_cast<const LineStyle*>(tag);
+						writer.write(style->join), writer.write(style->cap);
+					}
+					break;
+				case Tag::Type::LINE_DASH:{
+						const LineDash* dash = static_cast<const LineDash*>(tag);
+						writer.write(dash->offset),
+						writer.write_count(dash->dashes.size());
+						for(const Coord d : dash->dashes)
+							writer.write(d);
+					}
+					break;
+				case Tag::Type::MODE:
+					writer.write(static_cast<const Mode*>(tag)->method);
+					break;
+				case Tag::Type::DEFORM:{
+						const Deform* deform = static_cast<const Deform*>(tag);
+						writer.write(deform->formula_x), writer.write(deform->formula_y);
+					}
+					break;
+				case Tag::Type::POSITION:{
+						const Position* position = static_cast<const Position*>(tag);
+						writer.write(position->x), writer.write(position->y);
+					}
+					break;
+				case Tag::Type::ALIGN:
+					writer.write(static_cast<const Align*>(tag)->pos);
+					break;
+				case Tag::Type::MARGIN:
+					write_xy(writer, static_cast<const Margin*>(tag));
+					break;
+				case Tag::Type::DIRECTION:
+					writer.write(static_cast<const Direction*>(tag)->mode);
+					break;
+				case Tag::Type::IDENTITY:
+					break;
+				case Tag::Type::TRANSLATE:
+					write_xy(writer, static_cast<const Translate*>(tag));
+					break;
+				case Tag::Type::SCALE:
+					write_xy(writer, static_cast<const Scale*>(tag));
+					break;
+				case Tag::Type::ROTATE:{
+						const Rotate* rotation = static_cast<const Rotate*>(tag);
+						writer.write(rotation->axis),
+						writer.write(rotation->angle1);
+						if(rotation->axis != Rotate::Axis::Z)
+							writer.write(rotation->angle2);
+					}
+					break;
+				case Tag::Type::SHEAR:
+					write_xy(writer, static_cast<const Shear*>(tag));
+					break;
+				case Tag::Type::TRANSFORM:{
+						const Transform* t = static_cast<const Transform*>(tag);
+						for(const double value : {t->xx, t->xy, t->xz, t->x0, t->yx, t->yy, t->yz, t->y0, t->zx, t->zy, t->zz, t->z0})
+							writer.write(value);
+					}
+					break;
+				case Tag::Type::COLOR:
+					for(const RGB& color : static_cast<const Color*>(tag)->colors)
+						writer.write(color);
+					break;
+				case Tag::Type::LINE_COLOR:
+					writer.write(static_cast<const LineColor*>(tag)->color);
+					break;
+				case Tag::Type::ALPHA:
+					for(const Depth alpha : static_cast<const Alpha*>(tag)->alphas)
+						writer.write(alpha);
+					break;
+				case Tag::Type::LINE_ALPHA:
+					writer.write(static_cast<const LineAlpha*>(tag)->alpha);
+					break;
+				case Tag::Type::TEXTURE:
+					writer.write(static_cast<const Texture*>(tag)->filename);
+					break;
+				case Tag::Type::TEXFILL:{
+						const TexFill* texfill = static_cast<const TexFill*>(tag);
+						writer.write(texfill->x), writer.write(texfill->y), writer.write(texfill->wrap);
+					}
+					break;
+				case Tag::Type::BLEND:
+					writer.write(static_cast<const Blend*>(tag)->mode);
+					break;
+				case Tag::Type::BLUR:
+					write_xy(writer, static_cast<const Blur*>(tag));
+					break;
+				case Tag::Type::STENCIL:
+					writer.write(static_cast<const Stencil*>(tag)->mode);
+					break;
+				case Tag::Type::ANTI_ALIASING:
+					writer.write<uint8_t>(static_cast<const AntiAliasing*>(tag)->status);
+					break;
+				case Tag::Type::FADE:{
+						const Fade* fade = static_cast<const Fade*>(tag);
+						writer.write(fade->type);
+						if(fade->type != Fade::Type::OUTFADE)
+							writer.write<uint64_t>(fade->in);
+						if(fade->type != Fade::Type::INFADE)
+							writer.write<uint64_t>(fade->out);
+					}
+					break;
+				case Tag::Type::ANIMATE:{
+						const Animate* animate = static_cast<const Animate*>(tag);
+						writer.write<int64_t>(animate->start), writer.write<int64_t>(animate->end),
+						writer.write(animate->progress_formula);
+						write_objects(writer, animate->objects);
+					}
+					break;
+				case Tag::Type::KARAOKE:{
+						const Karaoke* karaoke = static_cast<const Karaoke*>(tag);
+						writer.write(karaoke->type), writer.write<uint64_t>(karaoke->time);
+					}
+					break;
+				case Tag::Type::KARAOKE_COLOR:
+					writer.write(static_cast<const KaraokeColor*>(tag)->color);
+					break;
+				case Tag::Type::KARAOKE_MODE:
+					writer.write(static_cast<const KaraokeMode*>(tag)->mode);
+					break;
+			}
+		}else{
+			const Geometry* geometry = static_cast<const Geometry*>(object);
+			writer.write(geometry->type);
+			switch(geometry->type){
+				case Geometry::Type::POINTS:{
+						const std::vector<Point>& points = static_cast<const Points*>(geometry)->points;
+						writer.write_count(points.size());
+						for(const Point& point : points)
+							writer.write(point.x), writer.write(point.y);
+					}
+					break;
+				case Geometry::Type::PATH:{
+						const std::vector<Path::Segment>& segments = static_cast<const Path*>(geometry)->segments;
+						writer.write_count(segments.size());
+						// Arcs consist of a center point segment followed by an angle segment
+						bool arc_angle = false;
+						for(const Path::Segment& segment : segments){
+							writer.write(segment.type);
+							if(segment.type == Path::SegmentType::ARC_TO && arc_angle)
+								writer.write(segment.angle);
+							else if(segment.type != Path::SegmentType::CLOSE)
+								writer.write(segment.point.x), writer.write(segment.point.y);
+							arc_angle = segment.type == Path::SegmentType::ARC_TO && !arc_angle;
+						}
+					}
+					break;
+				case Geometry::Type::TEXT:
+					writer.write(static_cast<const Text*>(geometry)->text);
+					break;
+			}
+		}
+	}
+}
+static void read_objects(SSB::BinaryReader& reader, SSB::Event& event, std::vector<SSB::Object*>& objects, bool in_animate = false){
+	using namespace SSB;
+	const size_t objects_n = reader.read_count();
+	objects.reserve(objects.size() + objects_n);
+	for(size_t object_i = 0; object_i < objects_n; ++object_i){
+		Object* object;
+		if(reader.read_enum(Object::Type::GEOMETRY) == Object::Type::TAG)
+			switch(reader.read_enum(Tag::Type::KARAOKE_MODE)){
+				case Tag::Type::FONT_FAMILY:
+					object = new(event.arena) FontFamily(reader.read_string());
+					break;
+				case Tag::Type::FONT_STYLE:{
+						const bool bold = reader.read_bool(), italic = reader.read_bool(), underline = reader.read_bool(), strikeout = reader.read_bool();
+						object = new(event.arena) FontStyle(bold, italic, underline, strikeout);
+					}
+					break;
+				case Tag::Type::FONT_SIZE:
+					object = new(event.arena) FontSize(reader.read<decltype(FontSize::size)>());
+					break;
+				case Tag::Type::FONT_SPACE:
+					object = read_xy<FontSpace>(reader, event);
+					break;
+				case Tag::Type::LINE_WIDTH:
+					object = new(event.arena) LineWidth(reader.read<Coord>());
+					break;
+				case Tag::Type::LINE_STYLE:{
+						const LineStyle::Join join = reader.read_enum(LineStyle::Join::BEVEL);
+						object = new(event.arena) LineStyle(join, reader.read_enum(LineStyle::Cap::FLAT));
+					}
+					break;
+				case Tag::Type::LINE_DASH:{
+						const Coord offset = reader.read<Coord>();
+						std::vector<Coord> dashes(reader.read_count(sizeof(Coord)));
+						for(Coord& d : dashes)
+							d = reader.read<Coord>();
+						object = new(event.arena) LineDash(offset, dashes);
+					}
+					break;
+				case Tag::Type::MODE:
+					object = new(event.arena) Mode(reader.read_enum(Mode::Method::BOXED));
+					break;
+				case Tag::Type::DEFORM:{
+						const std::string formula_x = reader.read_string();
+						object = new(event.arena) Deform(formula_x, reader.read_string());
+					}
+					break;
+				case Tag::Type::POSITION:{
+						const Coord x = reader.read<Coord>(), y = reader.read<Coord>();
+						object = new(event.arena) Position(x, y);
+					}
+					break;
+				case Tag::Type::ALIGN:{
+						const Align::Position pos = reader.read_enum(Align::Position::RIGHT_TOP);
+						if(pos < Align::Position::LEFT_BOTTOM)
+							throw Exception("Binary script contains invalid value");
+						object = new(event.arena) Align(pos);
+					}
+					break;
+				case Tag::Type::MARGIN:
+					object = read_xy<Margin>(reader, event);
+					break;
+				case Tag::Type::DIRECTION:
+					object = new(event.arena) Direction(reader.read_enum(Direction::Mode::TTB));
+					break;
+				case Tag::Type::IDENTITY:
+					object = new(event.arena) Identity();
+					break;
+				case Tag::Type::TRANSLATE:
+					object = read_xy<Translate>(reader, event);
+					break;
+				case Tag::Type::SCALE:
+					object = read_xy<Scale>(reader, event);
+					break;
+				case Tag::Type::ROTATE:{
+						const Rotate::Axis axis = reader.read_enum(Rotate::Axis::Z);
+						const double angle1 = reader.read<double>();
+						object = axis == Rotate::Axis::Z ? new(event.arena) Rotate(angle1) : new(event.arena) Rotate(axis, angle1, reader.read<double>());
+					}
+					break;
+				case Tag::Type::SHEAR:
+					object = read_xy<Shear>(reader, event);
+					break;
+				case Tag::Type::TRANSFORM:{
+						double m[12];
+						for(double& value : m)
+							value = reader.read<double>();
+						object = new(event.arena) Transform(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11]);
+					}
+					break;
+				case Tag::Type::COLOR:{
+						RGB c[4];
+						for(RGB& color : c)
+							color = reader.read_rgb();
+						object = new(event.arena) Color(c[0].r, c[0].g, c[0].b, c[1].r, c[1].g, c[1].b, c[2].r, c[2].g, c[2].b, c[3].r, c[3].g, c[3].b);
+					}
+					break;
+				case Tag::Type::LINE_COLOR:{
+						const RGB color = reader.read_rgb();
+						object = new(event.arena) LineColor(color.r, color.g, color.b);
+					}
+					break;
+				case Tag::Type::ALPHA:{
+						Depth a[4];
+						for(Depth& alpha : a)
+							alpha = reader.read<Depth>();
+						object = new(event.arena) Alpha(a[0], a[1], a[2], a[3]);
+					}
+					break;
+				case Tag::Type::LINE_ALPHA:
+					object = new(event.arena) LineAlpha(reader.read<Depth>());
+					break;
+				case Tag::Type::TEXTURE:
+					object = new(event.arena) Texture(reader.read_string());
+					break;
+				case Tag::Type::TEXFILL:{
+						const Coord x = reader.read<Coord>(), y = reader.read<Coord>();
+						object = new(event.arena) TexFill(x, y, reader.read_enum(TexFill::WrapStyle::FLOW));
+					}
+					break;
+				case Tag::Type::BLEND:
+					object = new(event.arena) Blend(reader.read_enum(Blend::Mode::DIFFERENCES));
+					break;
+				case Tag::Type::BLUR:
+					object = read_xy<Blur>(reader, event);
+					break;
+				case Tag::Type::STENCIL:
+					object = new(event.arena) Stencil(reader.read_enum(Stencil::Mode::OUTSIDE));
+					break;
+				case Tag::Type::ANTI_ALIASING:
+					object = new(event.arena) AntiAliasing(reader.read_bool());
+					break;
+				case Tag::Type::FADE:{
+						const Fade::Type type = reader.read_enum(Fade::Type::BOTH);
+						if(type == Fade::Type::BOTH){
+							const Time in = reader.read<uint64_t>(), out = reader.read<uint64_t>();
+							object = new(event.arena) Fade(in, out);
+						}else
+							object = new(event.arena) Fade(type, reader.read<uint64_t>());
+					}
+					break;
+				case Tag::Type::ANIMATE:{
+						if(in_animate)
+							throw Exception("Binary script contains nested animation");
+						const Duration start = reader.read<int64_t>(), end = reader.read<int64_t>();
+						const std::string progress_formula = reader.read_string();
+						std::vector<Object*> animate_objects;
+						read_objects(reader, event, animate_objects, true);
+						object = new(event.arena) Animate(start, end, progress_formula, std::move(animate_objects));
+					}
+					break;
+				case Tag::Type::KARAOKE:{
+						const Karaoke::Type type = reader.read_enum(Karaoke::Type::SET);
+						object = new(event.arena) Karaoke(type, reader.read<uint64_t>());
+					}
+					break;
+				case Tag::Type::KARAOKE_COLOR:{
+						const RGB color = reader.read_rgb();
+						object = new(event.arena) KaraokeColor(color.r, color.g, color.b);
+					}
+					break;
+				case Tag::Type::KARAOKE_MODE:
+					object = new(event.arena) KaraokeMode(reader.read_enum(KaraokeMode::Mode::GLOW));
+					break;
+			}
+		else
+			switch(reader.read_enum(Geometry::Type::TEXT)){
+				case Geometry::Type::POINTS:{
+						std::vector<Point> points(reader.read_count(sizeof(Coord) << 1));
+						for(Point& point : points)
+							point.x = reader.read<Coord>(),
+							point.y = reader.read<Coord>();
+						object = new(event.arena) Points(points);
+					}
+					break;
+				case Geometry::Type::PATH:{
+						std::vector<Path::Segment> segments(reader.read_count());
+						bool arc_angle = false;
+						for(Path::Segment& segment : segments){
+							segment.type = reader.read_enum(Path::SegmentType::CLOSE);
+							if(segment.type == Path::SegmentType::ARC_TO && arc_angle)
+								segment.angle = reader.read<double>();
+							else if(segment.type != Path::SegmentType::CLOSE)
+								segment.point.x = reader.read<Coord>(),
+								segment.point.y = reader.read<Coord>();
+							else
+								segment.point = {0, 0};
+							arc_angle = segment.type == Path::SegmentType::ARC_TO && !arc_angle;
+						}
+						object = new(event.arena) Path(segments);
+					}
+					break;
+				case Geometry::Type::TEXT:
+					object = new(event.arena) Text(reader.read_string());
+					break;
+			}
+		objects.push_back(event.arena.add(object));
+	}
+}
+
+namespace SSB{
+	constexpr unsigned Serializer::version;
+
+	bool Serializer::is_binary(const char* data, size_t data_size){
+		return data_size >= sizeof(binary_magic) && std::memcmp(data, binary_magic, sizeof(binary_magic)) == 0;
+	}
+
+	void Serializer::write(const Data& data, std::ostream& out) throw(Exception){
+		BinaryWriter writer(out);
+		// Header
+		out.write(binary_magic, sizeof(binary_magic));
+		writer.write<uint32_t>(version), writer.write(binary_byte_order);
+		// Meta & frame
+		writer.write(data.meta.title), writer.write(data.meta.description), writer.write(data.meta.author), writer.write(data.meta.version),
+		writer.write<uint32_t>(data.frame.width), writer.write<uint32_t>(data.frame.height);
+		// Styles (still needed for later added text lines)
+		writer.write_count(data.styles.size());
+		for(const std::pair<const std::string, std::string>& style : data.styles)
+			writer.write(style.first), writer.write(style.second);
+		// Events
+		writer.write<uint64_t>(data.events.size());
+		for(const Event& event : data.events)
+			if(!event.parsed)
+				throw Exception("Can't write unparsed (lazy) events");
+			else
+				writer.write<uint64_t>(event.start_ms), writer.write<uint64_t>(event.end_ms), writer.write<uint8_t>(event.static_tags),
+				write_objects(writer, event.objects);
+		if(!out)
+			throw Exception("Couldn't write binary script");
+	}
+
+	void Serializer::read(Data& data, const char* binary, size_t binary_size) throw(Exception){
+		if(!is_binary(binary, binary_size))
+			throw Exception("No binary script");
+		BinaryReader reader(binary + sizeof(binary_magic), binary_size - sizeof(binary_magic));
+		// Header
+		if(reader.read<uint32_t>() != version)
+			throw Exception("Binary script version not supported");
+		if(reader.read<uint32_t>() != binary_byte_order)
+			throw Exception("Binary script byte order not supported");
+		// Meta & frame
+		data.meta.title = reader.read_string(),
+		data.meta.description = reader.read_string(),
+		data.meta.author = reader.read_string(),
+		data.meta.version = reader.read_string(),
+		data.frame.width = reader.read<uint32_t>(),
+		data.frame.height = reader.read<uint32_t>();
+		// Styles
+		for(size_t styles_n = reader.read_count(); styles_n; --styles_n){
+			std::string name = reader.read_string();
+			data.styles[std::move(name)] = reader.read_string();
+		}
+		// Events
+		const uint64_t events_n = reader.read<uint64_t>();
+		if(events_n > static_cast<uint64_t>(binary + binary_size - reader.position()))	// Every event needs some bytes
+			throw Exception("Binary script is truncated");
+		data.events.reserve(data.events.size() + events_n);
+		for(uint64_t event_i = 0; event_i < events_n; ++event_i){
+			Event event;
+			event.start_ms = reader.read<uint64_t>(),
+			event.end_ms = reader.read<uint64_t>(),
+			event.static_tags = reader.read_bool();
+			read_objects(reader, event, event.objects);
+			data.events.push_back(std::move(event));
+		}
+		data.current_section = Data::Section::EVENTS;
+	}
+}	// namespace SSB
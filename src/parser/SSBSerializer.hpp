@@ -0,0 +1,33 @@
+/*
+Project: SSBRenderer
+File: SSBSerializer.hpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#pragma once
+
+#include "SSBData.hpp"
+#include <ostream>
+
+namespace SSB{
+	// Converter between parsed data and precompiled binary scripts
+	class Serializer{
+		public:
+			// Format version (increase on any layout change of binary data)
+			static constexpr unsigned version = 1;
+			// Check memory for binary script header
+			static bool is_binary(const char* data, size_t data_size);
+			// Write data as binary script
+			static void write(const Data& data, std::ostream& out) throw(Exception);
+			// Read binary script into data (events get appended)
+			static void read(Data& data, const char* binary, size_t binary_size) throw(Exception);
+	};
+}	// namespace SSB
@@ -0,0 +1,119 @@
+/*
+Project: SSBRenderer
+File: benchmark.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../SSBParser.hpp"
+#include <string>
+#include <cstdio>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+// Converts milliseconds to SSB timestamp
+static std::string ssb_time(unsigned long ms){
+	char buffer[16];
+	std::snprintf(buffer, sizeof(buffer), "%lu:%02lu:%02lu.%03lu", ms / 3600000 % 100, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+	return buffer;
+}
+
+int main(int argc, char** argv){
+	// Generate script with given number of events
+	const unsigned long events_n = argc > 1 ? std::stoul(argv[1]) : 100000;
+	std::string script = "#FRAME\nWidth: 1280\nHeight: 720\n\n#STYLES\nDefault: {ff=Arial;fs=20;cl=FFFFFF}\nBorder: {lw=2.5;lcl=000000}\n\n#EVENTS\n";
+	for(unsigned long i = 0; i < events_n; ++i)
+		switch(i % 4){
+			case 0: script += ssb_time(i) + '-' + ssb_time(i + 1500) + "|Default|Note|{an=2;pos=200.5,100;fst=b}Some \\{text\\} " + std::to_string(i) + '\n'; break;
+			case 1: script += ssb_time(i) + '-' + ssb_time(i + 2000) + "|||\\\\Border\\\\{gm=p;rz=45.5;fad=100,200}m 0 0 l 100 0 100 100 b 50 150 0 150 0 100 c\n"; break;
+			case 2: script += ssb_time(i) + '-' + ssb_time(i + 500) + "|Default||{cl=FF0000;ani=0,500,t,(cl=00FF00;sc=2)}Animated{k=20}karaoke\n"; break;
+			case 3: script += ssb_time(i) + '-' + ssb_time(i + 100) + "|||{gm=pt;tf=1,0,0,1,0,0,0,1,0,0,0,1;ld=0,10,5}0 0 10 10 20.5 30\n"; break;
+		}
+	// Parse script from memory sequentially & in parallel, measure time
+	SSB::Data data[3];
+	const unsigned threads_tests[] = {1, 0, 4};
+	for(unsigned test_i = 0; test_i < 3; ++test_i){
+		const unsigned threads = threads_tests[test_i];
+		SSB::Parser parser(SSB::Parser::Level::ALL, threads);
+		SSB::Data& parser_data = data[test_i];
+		const auto start = std::chrono::steady_clock::now();
+		parser.parse_script(parser_data, script.data(), script.size());
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if(parser_data.events.size() != events_n)
+			throw std::logic_error("Not all events were parsed");
+		std::cout << events_n << " events (" << script.size() << " bytes) parsed with " << (threads ? std::to_string(threads) : "all") << " thread(s) in " << seconds << " seconds = " << (seconds > 0 ? events_n / seconds : 0) << " lines/s" << std::endl;
+	}
+	// Compare parallel parsing result
+	for(unsigned test_i = 1; test_i < 3; ++test_i)
+		for(unsigned long i = 0; i < events_n; ++i)
+			if(data[0].events[i].start_ms != data[test_i].events[i].start_ms || data[0].events[i].objects.size() != data[test_i].events[i].objects.size())
+				throw std::logic_error("Parallel parsing result differs");
+	// Parse script lazily & complete events afterwards
+	{
+		SSB::Parser parser(SSB::Parser::Level::ALL, 1, SSB::Parser::Content::LAZY);
+		SSB::Data lazy_data;
+		auto start = std::chrono::steady_clock::now();
+		parser.parse_script(lazy_data, script.data(), script.size());
+		const double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		start = std::chrono::steady_clock::now();
+		for(SSB::Event& event : lazy_data.events)
+			parser.complete_event(lazy_data, event);
+		const double complete_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << events_n << " events loaded lazily in " << load_seconds << " seconds & completed in " << complete_seconds << " seconds" << std::endl;
+		for(unsigned long i = 0; i < events_n; ++i)
+			if(!lazy_data.events[i].parsed || data[0].events[i].objects.size() != lazy_data.events[i].objects.size() || data[0].events[i].static_tags != lazy_data.events[i].static_tags)
+				throw std::logic_error("Lazy parsing result differs");
+		// Events keeping their lines know inserted styles (by header & inline) for reparsing
+		if(lazy_data.events[0].style_names != std::vector<std::string>{"Default"} || lazy_data.events[1].style_names != std::vector<std::string>{"Border"} ||
+			!lazy_data.events[3].style_names.empty() || !data[0].events[1].style_names.empty())
+			throw std::logic_error("Event styles not tracked");
+		// Invalid lazy event becomes inactive on completion
+		SSB::Event broken;
+		if(!parser.parse_event(lazy_data, "0:00:00.000-0:00:01.000|||{cl=nonsense}Text", broken) || broken.parsed)
+			throw std::logic_error("Lazy event not postponed");
+		try{
+			parser.complete_event(lazy_data, broken);
+			throw std::logic_error("Lazy event error not found");
+		}catch(SSB::Exception){
+			if(!broken.parsed || broken.end_ms != 0 || !broken.objects.empty() || broken.source.empty())
+				throw std::logic_error("Invalid lazy event not inactive");
+		}
+	}
+	// Index script lines by time range only & parse them on demand
+	{
+		SSB::Parser parser(SSB::Parser::Level::ALL, 0, SSB::Parser::Content::INDEX);
+		SSB::Data index_data;
+		const auto start = std::chrono::steady_clock::now();
+		parser.parse_script(index_data, script.data(), script.size());
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << events_n << " events indexed in " << seconds << " seconds" << std::endl;
+		if(!index_data.events.empty() || index_data.event_lines.size() != events_n)
+			throw std::logic_error("Not all events were indexed");
+		for(unsigned long i = 0; i < events_n; i += 997){
+			const SSB::EventLine& event_line = index_data.event_lines[i];
+			SSB::Event event;
+			parser.parse_event(index_data, stdex::string_view(event_line.line, event_line.line_size), event);
+			if(event_line.start_ms != data[0].events[i].start_ms || event_line.end_ms != data[0].events[i].end_ms || event.objects.size() != data[0].events[i].objects.size())
+				throw std::logic_error("Indexed event differs");
+		}
+	}
+	// Check error line number of parallel parsing
+	script.insert(script.rfind("\n", script.length() - 2) + 1, "0-1|Unknown||\n");
+	try{
+		SSB::Data error_data;
+		SSB::Parser(SSB::Parser::Level::ALL, 4).parse_script(error_data, script.data(), script.size());
+		throw std::logic_error("Parallel parsing error not found");
+	}catch(SSB::Exception e){
+		if(std::string(e.what()) != std::to_string(events_n + 9) + ": Couldn't find style")
+			throw std::logic_error("Parallel parsing error at wrong line: " + std::string(e.what()));
+	}
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+Project: SSBRenderer
+File: serializer.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../SSBParser.hpp"
+#include "../SSBSerializer.hpp"
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+
+int main(){
+	// Script with every tag & geometry type
+	const std::string script = "#META\nTitle: Serializer\nAuthor: Test\n\n#FRAME\nWidth: 640\nHeight: 480\n\n#STYLES\nRed: {cl=FF0000}\n\n#EVENTS\n"
+		"0-1.0|Red||{ff=Arial;fst=bius;fs=20;fsp=1.5,2;fsph=3;fspv=4;lw=2;lst=b,f;ld=1,2,3;md=w;df=x,y+1;pos=1,2;an=7;mg=5;mgh=6;mgv=7;dir=ttb}Text\n"
+		"0-2.0|||{tl=1,2;tlx=3;tly=4;sc=2;scx=3;scy=4;rxy=10,20;ryx=30,40;rz=50;sh=0.5,1;shx=2;shy=3;tf=1,2,3,4,5,6,7,8,9,10,11,12;gm=p}m 0 0 l 10 0 b 20 0 20 10 10 10 a 5 5 180 c\n"
+		"0-3.0|||{cl=FF0000,00FF00;lcl=0000FF;al=80,40,20,10;lal=FF;tex=image.png;texf=1,2,m;bld=mult;bl=2;blh=3;blv=4;stc=in;aa=off;gm=pt}0 0 1 1\n"
+		"0-4.0|||{fad=100,200;fadi=10;fado=20;ani=0,500,t*t,(cl=00FF00;rz=90);k=10;ks=20;kc=FFFF00;km=g}Animated\n";
+	SSB::Data text_data;
+	SSB::Parser().parse_script(text_data, script.data(), script.size());
+	// Write binary script
+	std::ostringstream binary;
+	SSB::Serializer::write(text_data, binary);
+	const std::string binary_script = binary.str();
+	if(!SSB::Serializer::is_binary(binary_script.data(), binary_script.size()) || SSB::Serializer::is_binary(script.data(), script.size()))
+		throw std::logic_error("Binary script not detected");
+	// Load binary script by parser & write it again
+	SSB::Data binary_data;
+	SSB::Parser().parse_script(binary_data, binary_script.data(), binary_script.size());
+	if(binary_data.meta.title != "Serializer" || binary_data.frame.width != 640 || binary_data.styles.size() != 1 ||
+		binary_data.events.size() != text_data.events.size() || binary_data.events.back().static_tags)
+		throw std::logic_error("Binary script content differs");
+	std::ostringstream binary_again;
+	SSB::Serializer::write(binary_data, binary_again);
+	if(binary_again.str() != binary_script)
+		throw std::logic_error("Binary script roundtrip differs");
+	// Reject truncated binary script
+	try{
+		SSB::Data truncated_data;
+		SSB::Serializer::read(truncated_data, binary_script.data(), binary_script.size() - 1);
+		throw std::logic_error("Truncated binary script accepted");
+	}catch(SSB::Exception e){
+		std::cout << "Expected error: " << e.what() << std::endl;
+	}
+	// Reject element count exceeding binary script (instead of allocating it)
+	try{
+		const std::string points_script = "#EVENTS\n0-1.0|||{gm=pt}0 0 1 1\n";
+		SSB::Data oversized_data;
+		SSB::Parser().parse_script(oversized_data, points_script.data(), points_script.size());
+		std::ostringstream points_binary;
+		SSB::Serializer::write(oversized_data, points_binary);
+		std::string oversized_script = points_binary.str();
+		oversized_script.replace(oversized_script.size() - 4 * sizeof(SSB::Coord) - 4, 4, "\xff\xff\xff\x7f", 4);	// Points count
+		oversized_data = SSB::Data();
+		SSB::Serializer::read(oversized_data, oversized_script.data(), oversized_script.size());
+		throw std::logic_error("Oversized element count accepted");
+	}catch(SSB::Exception e){
+		std::cout << "Expected error: " << e.what() << std::endl;
+	}
+	// Reject nested animations (forbidden in text scripts too)
+	try{
+		SSB::Data nested_data;
+		SSB::Event event;
+		event.objects.push_back(event.arena.add(new(event.arena) SSB::Animate(0, 100, "", {
+			event.arena.add(new(event.arena) SSB::Animate(0, 50, "", {}))
+		})));
+		nested_data.events.push_back(std::move(event));
+		std::ostringstream nested_binary;
+		SSB::Serializer::write(nested_data, nested_binary);
+		const std::string nested_script = nested_binary.str();
+		SSB::Data nested_read_data;
+		SSB::Serializer::read(nested_read_data, nested_script.data(), nested_script.size());
+		throw std::logic_error("Nested animation accepted");
+	}catch(SSB::Exception e){
+		std::cout << "Expected error: " << e.what() << std::endl;
+	}
+	std::cout << text_data.events.size() << " events in " << script.size() << " bytes text & " << binary_script.size() << " bytes binary" << std::endl;
+	return 0;
+}
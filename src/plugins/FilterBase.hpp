@@ -64,7 +64,7 @@ namespace FilterBase{
 	// CSRI processes
 	namespace CSRI{
 		bool init(const char* filename, void** userdata);
-		bool init(std::istream& stream, void** userdata);
+		bool init(const char* data, size_t data_size, void** userdata);
 		void setup(VideoInfo vinfo, void** userdata);
 		void filter_frame(unsigned char* image_data, int stride, unsigned long ms, void** userdata);
 		void deinit(void* userdata);
@@ -24,7 +24,7 @@ using csri_inst = void*;
 
 #include "FilterBase.hpp"
 
-#include <sstream>
+#include <cstring>
 
 // Only renderer
 csri_rend csri_user_renderer = FilterBase::get_name();
@@ -41,9 +41,8 @@ CSRIAPI csri_inst* csri_open_file(csri_rend*, const char* filename, struct csri_
 
 // Open interface with memory content
 CSRIAPI csri_inst* csri_open_mem(csri_rend*, const void* data, size_t length, struct csri_openflag*){
-	std::istringstream stream(std::string(reinterpret_cast<char*>(const_cast<void*>(data)), length));
 	void** userdata = new void*(nullptr);
-	if(!FilterBase::CSRI::init(stream, userdata)){
+	if(!FilterBase::CSRI::init(reinterpret_cast<const char*>(data), length, userdata)){
 		delete userdata;
 		return nullptr;
 	}
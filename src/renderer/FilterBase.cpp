@@ -139,10 +139,10 @@ namespace FilterBase{
 						current_section = SSB::Data::Section::STYLES;
 					short al, lal;
 					float scx, scy;
-					stdex::hex_string_to_number(m[4], al),
-					stdex::hex_string_to_number(m[11], lal),
-					stdex::string_to_number(m[19], scx),
-					stdex::string_to_number(m[20], scy),
+					stdex::hex_string_to_number(m[4].str(), al),
+					stdex::hex_string_to_number(m[11].str(), lal),
+					stdex::string_to_number(m[19].str(), scx),
+					stdex::string_to_number(m[20].str(), scy),
 					out << m[1] << ": " << "{ff=" << m[2] << ";fs=" << m[3]
 						<< ";cl=" << m[7] << m[6] << m[5]
 						<< ";kc=" << m[10] << m[9] << m[8]
@@ -167,20 +167,21 @@ namespace FilterBase{
 #endif
 		bool init(const char* filename, void** userdata){
 			try{
-				*userdata = new SSB::Renderer(0, 0, SSB::Colorspace::BGR, filename, false);
+				*userdata = new SSB::Renderer(0, 0, SSB::Colorspace::BGR, filename, false, SSB::Renderer::Loading::BACKGROUND);
 			}catch(SSB::Exception){
 				return false;
 			}
 			return true;
 		}
-		bool init(std::istream& stream, void** userdata){
+		bool init(const char* data, size_t data_size, void** userdata){
 #ifdef USE_AEGISUB_INTERFACE
+			stdex::imemstream stream(stdex::string_view(data, data_size));
 			std::stringstream ssb_stream;
 			try{
 				*userdata = new SSB::Renderer(0, 0, SSB::Colorspace::BGR, convert_ass_ssb(stream, ssb_stream), false);
 #else
 			try{
-				*userdata = new SSB::Renderer(0, 0, SSB::Colorspace::BGR, stream, false);
+				*userdata = new SSB::Renderer(0, 0, SSB::Colorspace::BGR, data, data_size, false);
 #endif
 			}catch(SSB::Exception){
 				return false;
@@ -13,10 +13,8 @@ Permission is granted to anyone to use this software for any purpose, including
 */
 
 #include "Geometry.hpp"
-#include <muParser.h>
-#include "../utils/memory.hpp"
-#include <config.h>
-#include <mutex>
+#include <cmath>
+#include <algorithm>
 
 #define DEG_TO_RAD(x) (x * M_PI / 180.0)
 
@@ -74,47 +72,6 @@ namespace SSB{
 		return result;
 	}
 
-	void path_deform(std::vector<GUtils::PathSegment>& path, const std::string& x_formula, const std::string& y_formula, double progress){
-        	// Static resources
-        	struct ParserPack{	// Parsers + variables to reference
-			mu::Parser x_parser, y_parser;
-			double x, y, t;
-        	};
-		static stdex::Cache<std::pair<std::string,std::string>, std::shared_ptr<ParserPack>, MAX_CACHE> parsers_cache;	// Cache for reusable parsers
-		static std::mutex mut;	// Lock object for thread-safe usage of parsers
-		// Make parsers usage thread-safe
-		std::unique_lock<std::mutex> lock(mut);
-		// Pick parser(s)
-		std::shared_ptr<ParserPack> parser;
-		std::pair<std::string,std::string> formula(x_formula, y_formula);
-		if(parsers_cache.contains(formula))
-			parser = parsers_cache.get(formula);
-		else{
-			std::shared_ptr<ParserPack> new_parser(new ParserPack);
-			new_parser->x_parser.DefineVar("x", &parser->x),
-			new_parser->x_parser.DefineVar("y", &parser->y),
-			new_parser->x_parser.DefineVar("t", &parser->t),
-			new_parser->x_parser.SetExpr(x_formula),
-			new_parser->y_parser.DefineVar("x", &parser->x),
-			new_parser->y_parser.DefineVar("y", &parser->y),
-			new_parser->y_parser.DefineVar("t", &parser->t),
-			new_parser->y_parser.SetExpr(y_formula),
-			parsers_cache.add(formula, new_parser),
-			parser = new_parser;
-		}
-		// Apply parsers to path points
-		parser->t = progress;
-		for(GUtils::PathSegment& segment : path)
-			if(segment.type != GUtils::PathSegment::Type::CLOSE){
-				parser->x = segment.x,
-				parser->y = segment.y;
-				try{
-					segment.x = parser->x_parser.Eval(),
-					segment.y = parser->y_parser.Eval();
-				}catch(...){}
-			}
-        }
-
 	void get_2d_scale(unsigned src_width, unsigned src_height, unsigned dst_width, unsigned dst_height, double& scale_x, double& scale_y){
 		if(dst_width > 0 && dst_height > 0)
 			scale_x = static_cast<double>(src_width) / dst_width,
@@ -241,4 +198,19 @@ namespace SSB{
 		// Return whatever was set
 		return offset;
 	}
+
+	RenderArea get_render_area(double min_x, double min_y, double max_x, double max_y, double blur_h, double blur_v,
+			unsigned frame_width, unsigned frame_height){
+		// Blur spreads by kernel radius, antialiasing by one pixel
+		const double margin_h = std::ceil(std::max(blur_h, 0.0)) + 1,
+			margin_v = std::ceil(std::max(blur_v, 0.0)) + 1;
+		// Content outside frame is needed up to margin for blur into frame
+		const double x0 = std::max(std::floor(min_x - margin_h), -margin_h),
+			y0 = std::max(std::floor(min_y - margin_v), -margin_v),
+			x1 = std::min(std::ceil(max_x + margin_h), frame_width + margin_h),
+			y1 = std::min(std::ceil(max_y + margin_v), frame_height + margin_v);
+		if(!(x0 < x1 && y0 < y1))
+			return {0, 0, 0, 0};
+		return {static_cast<int>(x0), static_cast<int>(y0), static_cast<unsigned>(x1 - x0), static_cast<unsigned>(y1 - y0)};
+	}
 }
@@ -22,8 +22,6 @@ namespace SSB{
 	std::vector<GUtils::PathSegment> points_to_path(const Points* points, double size);
 	// Convert SSB path to general path
 	std::vector<GUtils::PathSegment> path_to_path(const Path* path);
-	// Deform path by formula (with progress variable)
-	void path_deform(std::vector<GUtils::PathSegment>& path, const std::string& x_formula, const std::string& y_formula, double progress);
 	// Calculate 2-dimensional scale by source & target
 	void get_2d_scale(unsigned src_width, unsigned src_height, unsigned dst_width, unsigned dst_height, double& scale_x, double& scale_y);
 	// Calculate auto position (by alignment, frame+scale and margins)
@@ -46,4 +44,11 @@ namespace SSB{
 	// Calculate line offset to block origin by alignment
 	Point get_line_offset(Align::Position align, Direction::Mode mode,
 			const GeometriesBlock& geometries, unsigned line_i);
+	// Frame area to render extents into (plus blur & antialiasing margins, limited to frame + margins; empty for invisible extents)
+	struct RenderArea{
+		int x, y;
+		unsigned width, height;
+	};
+	RenderArea get_render_area(double min_x, double min_y, double max_x, double max_y, double blur_h, double blur_v,
+			unsigned frame_width, unsigned frame_height);
 }
@@ -69,11 +69,11 @@ namespace SSB{
 					Time start_ms, Duration inner_ms){
 		switch(tag->type){
 			case Tag::Type::FONT_FAMILY:
-				state.font_family = dynamic_cast<const FontFamily*>(tag)->family;
+				state.font_family = static_cast<const FontFamily*>(tag)->family;
 				break;
 			case Tag::Type::FONT_STYLE:
 				{
-					const FontStyle* style = dynamic_cast<const FontStyle*>(tag);
+					const FontStyle* style = static_cast<const FontStyle*>(tag);
 					state.bold = style->bold,
 					state.italic = style->italic,
 					state.underline = style->underline,
@@ -81,11 +81,11 @@ namespace SSB{
 				}
 				break;
 			case Tag::Type::FONT_SIZE:
-				state.font_size = dynamic_cast<const FontSize*>(tag)->size;
+				state.font_size = static_cast<const FontSize*>(tag)->size;
 				break;
 			case Tag::Type::FONT_SPACE:
 				{
-					const FontSpace* space = dynamic_cast<const FontSpace*>(tag);
+					const FontSpace* space = static_cast<const FontSpace*>(tag);
 					switch(space->type){
 						case FontSpace::Type::HORIZONTAL:
 							state.font_space_h = space->x;
@@ -101,11 +101,11 @@ namespace SSB{
 				}
 				break;
 			case Tag::Type::LINE_WIDTH:
-				state.line_width = dynamic_cast<const LineWidth*>(tag)->width;
+				state.line_width = static_cast<const LineWidth*>(tag)->width;
 				break;
 			case Tag::Type::LINE_STYLE:
 				{
-					const LineStyle* style = dynamic_cast<const LineStyle*>(tag);
+					const LineStyle* style = static_cast<const LineStyle*>(tag);
 					switch(style->join){
 						case LineStyle::Join::BEVEL:
 							state.line_join = Backend::Renderer::LineJoin::BEVEL;
@@ -126,13 +126,13 @@ namespace SSB{
 				break;
 			case Tag::Type::LINE_DASH:
 				{
-					const LineDash* dash = dynamic_cast<const LineDash*>(tag);
+					const LineDash* dash = static_cast<const LineDash*>(tag);
 					state.dash_offset = dash->offset,
 					state.dashes = dash->dashes;
 				}
 				break;
 			case Tag::Type::MODE:
-				switch(dynamic_cast<const Mode*>(tag)->method){
+				switch(static_cast<const Mode*>(tag)->method){
 					case Mode::Method::FILL:
 						state.mode = Backend::Renderer::Mode::FILL;
 						break;
@@ -146,7 +146,7 @@ namespace SSB{
 				break;
 			case Tag::Type::DEFORM:
 				{
-					const Deform* formula = dynamic_cast<const Deform*>(tag);
+					const Deform* formula = static_cast<const Deform*>(tag);
 					state.deform_x = formula->formula_x,
 					state.deform_y = formula->formula_y,
 					state.deform_progress = 0;
@@ -154,17 +154,17 @@ namespace SSB{
 				break;
 			case Tag::Type::POSITION:
 				{
-					const Position* position = dynamic_cast<const Position*>(tag);
+					const Position* position = static_cast<const Position*>(tag);
 					state.pos_x = position->x,
 					state.pos_y = position->y;
 				}
 				break;
 			case Tag::Type::ALIGN:
-				state.align = dynamic_cast<const Align*>(tag)->pos;
+				state.align = static_cast<const Align*>(tag)->pos;
 				break;
 			case Tag::Type::MARGIN:
 				{
-					const Margin* margins = dynamic_cast<const Margin*>(tag);
+					const Margin* margins = static_cast<const Margin*>(tag);
 					switch(margins->type){
 						case Margin::Type::HORIZONTAL:
 							state.margin_h = margins->x;
@@ -180,14 +180,14 @@ namespace SSB{
 				}
 				break;
 			case Tag::Type::DIRECTION:
-				state.vertical = dynamic_cast<const Direction*>(tag)->mode == Direction::Mode::TTB;
+				state.vertical = static_cast<const Direction*>(tag)->mode == Direction::Mode::TTB;
 				break;
 			case Tag::Type::IDENTITY:
 				state.matrix.identity();
 				break;
 			case Tag::Type::TRANSLATE:
 				{
-					const Translate* translation = dynamic_cast<const Translate*>(tag);
+					const Translate* translation = static_cast<const Translate*>(tag);
 					switch(translation->type){
 						case Translate::Type::HORIZONTAL:
 							state.matrix.translate(translation->x, 0, 0);
@@ -203,7 +203,7 @@ namespace SSB{
 				break;
 			case Tag::Type::SCALE:
 				{
-					const Scale* scale = dynamic_cast<const Scale*>(tag);
+					const Scale* scale = static_cast<const Scale*>(tag);
 					switch(scale->type){
 						case Scale::Type::HORIZONTAL:
 							state.matrix.scale(scale->x, 0, 0);
@@ -219,7 +219,7 @@ namespace SSB{
 				break;
 			case Tag::Type::ROTATE:
 				{
-					const Rotate* rotation = dynamic_cast<const Rotate*>(tag);
+					const Rotate* rotation = static_cast<const Rotate*>(tag);
 					switch(rotation->axis){
 						case Rotate::Axis::XY:
 							state.matrix.rotate_x(DEG_TO_RAD(rotation->angle1)).rotate_y(DEG_TO_RAD(rotation->angle2));
@@ -235,7 +235,7 @@ namespace SSB{
 				break;
 			case Tag::Type::SHEAR:
 				{
-					const Shear* shear = dynamic_cast<const Shear*>(tag);
+					const Shear* shear = static_cast<const Shear*>(tag);
 					switch(shear->type){
 						case Shear::Type::HORIZONTAL:
 							state.matrix.multiply({
@@ -267,7 +267,7 @@ namespace SSB{
 				break;
 			case Tag::Type::TRANSFORM:
 				{
-					const Transform* transformation = dynamic_cast<const Transform*>(tag);
+					const Transform* transformation = static_cast<const Transform*>(tag);
 					state.matrix.multiply({
 						transformation->xx, transformation->xy, transformation->xz, transformation->x0,
 						transformation->yx, transformation->yy, transformation->yz, transformation->y0,
@@ -278,7 +278,7 @@ namespace SSB{
 				break;
 			case Tag::Type::COLOR:
 				{
-					const Color* color = dynamic_cast<const Color*>(tag);
+					const Color* color = static_cast<const Color*>(tag);
 					state.fill_color[0][0] = color->colors[0].r,
 					state.fill_color[0][1] = color->colors[0].g,
 					state.fill_color[0][2] = color->colors[0].b,
@@ -295,13 +295,13 @@ namespace SSB{
 				break;
 			case Tag::Type::LINE_COLOR:
 				{
-					const LineColor* lcolor = dynamic_cast<const LineColor*>(tag);
+					const LineColor* lcolor = static_cast<const LineColor*>(tag);
 					state.line_color = {lcolor->color.r, lcolor->color.g, lcolor->color.b, state.line_color[3]};
 				}
 				break;
 			case Tag::Type::ALPHA:
 				{
-					const Alpha* alpha = dynamic_cast<const Alpha*>(tag);
+					const Alpha* alpha = static_cast<const Alpha*>(tag);
 					state.fill_color[0][3] = alpha->alphas[0],
 					state.fill_color[1][3] = alpha->alphas[1],
 					state.fill_color[2][3] = alpha->alphas[2],
@@ -309,14 +309,14 @@ namespace SSB{
 				}
 				break;
 			case Tag::Type::LINE_ALPHA:
-				state.line_color[3] = dynamic_cast<const LineAlpha*>(tag)->alpha;
+				state.line_color[3] = static_cast<const LineAlpha*>(tag)->alpha;
 				break;
 			case Tag::Type::TEXTURE:
-				state.texture_filename = dynamic_cast<const Texture*>(tag)->filename;
+				state.texture_filename = static_cast<const Texture*>(tag)->filename;
 				break;
 			case Tag::Type::TEXFILL:
 				{
-					const TexFill* texfill = dynamic_cast<const TexFill*>(tag);
+					const TexFill* texfill = static_cast<const TexFill*>(tag);
 					state.texture_x = texfill->x,
 					state.texture_y = texfill->y;
 					switch(texfill->wrap){
@@ -336,11 +336,11 @@ namespace SSB{
 				}
 				break;
 			case Tag::Type::BLEND:
-				state.blend_mode = dynamic_cast<const Blend*>(tag)->mode;
+				state.blend_mode = static_cast<const Blend*>(tag)->mode;
 				break;
 			case Tag::Type::BLUR:
 				{
-					const Blur* blur = dynamic_cast<const Blur*>(tag);
+					const Blur* blur = static_cast<const Blur*>(tag);
 					switch(blur->type){
 						case Blur::Type::HORIZONTAL:
 							state.blur_h = blur->x;
@@ -356,14 +356,14 @@ namespace SSB{
 				}
 				break;
 			case Tag::Type::STENCIL:
-				state.stencil_mode = dynamic_cast<const Stencil*>(tag)->mode;
+				state.stencil_mode = static_cast<const Stencil*>(tag)->mode;
 				break;
 			case Tag::Type::ANTI_ALIASING:
-				state.anti_aliasing = dynamic_cast<const AntiAliasing*>(tag)->status;
+				state.anti_aliasing = static_cast<const AntiAliasing*>(tag)->status;
 				break;
 			case Tag::Type::FADE:
 				{
-					const Fade* fade = dynamic_cast<const Fade*>(tag);
+					const Fade* fade = static_cast<const Fade*>(tag);
 					switch(fade->type){
 						case Fade::Type::INFADE:
 							state.fade_in = fade->in;
@@ -383,7 +383,7 @@ namespace SSB{
 				break;
 			case Tag::Type::KARAOKE:
 				{
-					const Karaoke* karaoke = dynamic_cast<const Karaoke*>(tag);
+					const Karaoke* karaoke = static_cast<const Karaoke*>(tag);
 					switch(karaoke->type){
 						case Karaoke::Type::DURATION:
 							// Activate karaoke
@@ -402,12 +402,12 @@ namespace SSB{
 				break;
 			case Tag::Type::KARAOKE_COLOR:
 				{
-					const KaraokeColor* color = dynamic_cast<const KaraokeColor*>(tag);
+					const KaraokeColor* color = static_cast<const KaraokeColor*>(tag);
 					state.karaoke_color = {color->color.r, color->color.g, color->color.b};
 				}
 				break;
 			case Tag::Type::KARAOKE_MODE:
-				state.karaoke_mode = dynamic_cast<const KaraokeMode*>(tag)->mode;
+				state.karaoke_mode = static_cast<const KaraokeMode*>(tag)->mode;
 				break;
 		}
 	}
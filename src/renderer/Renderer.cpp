@@ -14,45 +14,330 @@ Permission is granted to anyone to use this software for any purpose, including
 
 #include "Renderer.hpp"
 #include "../parser/SSBParser.hpp"
+#include "../parser/SSBSerializer.hpp"
 #include "../utils/io.hpp"
 #include "Geometry.hpp"
 #include "RenderState.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
 namespace SSB{
-	void Renderer::init(int width, int height, Colorspace format, std::istream& data, bool warnings) throw(Exception){
+	void Renderer::init(int width, int height, Colorspace format, std::istream& data) throw(Exception){
 		this->set_target(width, height, format);
-		Parser(warnings ? Parser::Level::ALL : Parser::Level::OFF).parse_script(this->script_data, data);
+		this->parser.parse_script(this->script_data, data);
+		this->index_events(this->script_data.events);
 	}
 
-	Renderer::Renderer(int width, int height, Colorspace format, const std::string& script, bool warnings) throw(Exception)
-	: script_directory(stdex::get_file_dir(script)){
-		stdex::fstream file(script, stdex::fstream::in);
-		if(!file)
+	void Renderer::init(int width, int height, Colorspace format, const char* data, size_t data_size) throw(Exception){
+		this->set_target(width, height, format);
+		this->parser.parse_script(this->script_data, data, data_size);
+		this->index_events(this->script_data.events);
+	}
+
+	void Renderer::index_events(std::vector<Event>& events){
+		for(Event& event : events)
+			this->precompiled |= event.source.empty(),
+			this->event_ids[this->next_event_id++] = this->events.insert(this->events.end(), std::move(event));
+		events.clear(),
+		events.shrink_to_fit();
+	}
+
+	void Renderer::index_stream(){
+		// Precompiled scripts come with parsed events
+		if(!this->script_data.events.empty()){
+			this->script_file.close();
+			this->index_events(this->script_data.events);
+			return;
+		}
+		// Sort event lines by start time & note long ones
+		const std::vector<EventLine>& lines = this->script_data.event_lines;
+		this->stream_order.resize(lines.size());
+		for(size_t i = 0; i < lines.size(); ++i){
+			this->stream_order[i] = i;
+			if(lines[i].end_ms > lines[i].start_ms + STREAM_WINDOW)
+				this->stream_long_lines.push_back(i);
+		}
+		std::stable_sort(this->stream_order.begin(), this->stream_order.end(), [&lines](size_t a, size_t b){return lines[a].start_ms < lines[b].start_ms;});
+		this->streaming = true;
+	}
+
+	void Renderer::update_stream_window(Time ms){
+		// Current window still valid?
+		if(ms >= this->stream_window_start && ms < this->stream_window_end)
+			return;
+		const Time window_start = ms, window_end = ms + STREAM_WINDOW;
+		// Collect event lines in new window (short ones start at most one window length before)
+		const std::vector<EventLine>& lines = this->script_data.event_lines;
+		std::vector<size_t> window_lines;
+		for(auto line = std::lower_bound(this->stream_order.begin(), this->stream_order.end(), window_start > STREAM_WINDOW ? window_start - STREAM_WINDOW : 0,
+						[&lines](size_t i, Time start_ms){return lines[i].start_ms < start_ms;});
+				line != this->stream_order.end() && lines[*line].start_ms < window_end; ++line)
+			if(lines[*line].end_ms > window_start && lines[*line].end_ms <= lines[*line].start_ms + STREAM_WINDOW)
+				window_lines.push_back(*line);
+		for(size_t line : this->stream_long_lines)
+			if(lines[line].start_ms < window_end && lines[line].end_ms > window_start)
+				window_lines.push_back(line);
+		std::sort(window_lines.begin(), window_lines.end());
+		// Evict events out of window (parsed ones in window stay)
+		for(auto event = this->stream_events.begin(); event != this->stream_events.end();)
+			if(std::binary_search(window_lines.begin(), window_lines.end(), event->first))
+				++event;
+			else
+				this->event_cache.remove(&event->second),
+				event = this->stream_events.erase(event);
+		// Add new events for parsing on activation
+		for(size_t line : window_lines){
+			auto event = this->stream_events.emplace(line, Event());
+			if(event.second)
+				event.first->second.start_ms = lines[line].start_ms,
+				event.first->second.end_ms = lines[line].end_ms,
+				event.first->second.source.assign(lines[line].line, lines[line].line_size),
+				event.first->second.parsed = false;
+		}
+		this->stream_window_start = window_start,
+		this->stream_window_end = window_end;
+	}
+
+	void Renderer::clear_stream_window(){
+		for(auto& event : this->stream_events)
+			this->event_cache.remove(&event.second);
+		this->stream_events.clear(),
+		this->stream_window_end = this->stream_window_start;
+	}
+
+	// Constructors convert backend & allocation failures to SSB exceptions (by function try blocks)
+	Renderer::Renderer(int width, int height, Colorspace format, const std::string& script, bool warnings, Loading loading) throw(Exception)
+	try : parser(warnings ? Parser::Level::ALL : Parser::Level::OFF, 0, warnings ? Parser::Content::SOURCE : Parser::Content::LAZY), script_directory(stdex::get_file_dir(script)){
+		if(!this->script_file.open(script))
 			throw Exception("Couldn't open file \"" + script + '\"');
-		this->init(width, height, format, file, warnings);
+		// Stream big script without warnings (event lines stay in file mapping)
+		if(!warnings && this->script_file.size() >= static_cast<size_t>(STREAM_MIN_SIZE) << 20){
+			this->set_target(width, height, format);
+			Parser(Parser::Level::OFF, 1, Parser::Content::INDEX).parse_script(this->script_data, this->script_file.data(), this->script_file.size());
+			this->index_stream();
+		// Parse script on background thread
+		}else if(loading == Loading::BACKGROUND){
+			this->set_target(width, height, format);
+			this->load_size = this->script_file.size(),
+			this->load_done = false,
+			this->load_thread = std::thread(&Renderer::load, this, this->parser.level, this->parser.content);
+		}else
+			this->init(width, height, format, this->script_file.data(), this->script_file.size()),
+			this->script_file.close();
+	}catch(const std::exception& e){
+		throw Exception(e.what());
 	}
 
-	Renderer::Renderer(int width, int height, Colorspace format, std::istream& data, bool warnings) throw(Exception){
+	Renderer::Renderer(int width, int height, Colorspace format, std::istream& data, bool warnings) throw(Exception)
+	try : parser(warnings ? Parser::Level::ALL : Parser::Level::OFF, 0, warnings ? Parser::Content::SOURCE : Parser::Content::LAZY){
 		if(!data)
 			throw Exception("Bad data stream");
-		this->init(width, height, format, data, warnings);
+		this->init(width, height, format, data);
+	}catch(const std::exception& e){
+		throw Exception(e.what());
+	}
+
+	Renderer::Renderer(int width, int height, Colorspace format, const char* data, size_t data_size, bool warnings) throw(Exception)
+	try : parser(warnings ? Parser::Level::ALL : Parser::Level::OFF, 0, warnings ? Parser::Content::SOURCE : Parser::Content::LAZY){
+		if(!data)
+			throw Exception("Bad data memory");
+		this->init(width, height, format, data, data_size);
+	}catch(const std::exception& e){
+		throw Exception(e.what());
+	}
+
+	Renderer::~Renderer(){
+		this->load_cancel = true;
+		if(this->load_thread.joinable())
+			this->load_thread.join();
+	}
+
+	void Renderer::load(Parser::Level level, Parser::Content content){
+		// Own parser & data for this thread, committed after every part
+		Parser parser(level, 0, content);
+		Data data;
+		const char* script = this->script_file.data();
+		// Earliest start of events after each event line (by indexing lines first, so unsorted scripts don't get rendered without their later events)
+		Data index;
+		std::vector<Time> later_start(1, std::numeric_limits<Time>::max());
+		size_t loaded_lines = 0;
+		// Commit script state & events parsed so far to renderer
+		auto commit = [&](size_t pos){
+			{
+				std::lock_guard<std::mutex> lock(this->load_mutex);
+				this->script_data.meta = data.meta,
+				this->script_data.frame = data.frame;
+				for(const std::pair<const std::string, std::string>& style : data.styles)
+					this->script_data.styles[style.first] = style.second;	// Later definitions overwrite, like synchronous loading
+				while(loaded_lines < index.event_lines.size() && index.event_lines[loaded_lines].line < script + pos)
+					++loaded_lines;
+				this->load_watermark = later_start[loaded_lines],
+				this->index_events(data.events),
+				this->load_position = pos;
+			}
+			this->load_condition.notify_all();
+		};
+		size_t pos = 0;
+		try{
+			// Parse script in parts ending at line breaks (precompiled scripts at once)
+			static const size_t part_min_size = 1 << 20;
+			const bool binary = Serializer::is_binary(script, this->load_size);
+			if(!binary){
+				Parser(Parser::Level::OFF, 1, Parser::Content::INDEX).parse_script(index, script, this->load_size),
+				later_start.resize(index.event_lines.size() + 1, std::numeric_limits<Time>::max());
+				for(size_t i = index.event_lines.size(); i-- > 0;)
+					later_start[i] = std::min(later_start[i+1], index.event_lines[i].start_ms);
+			}
+			unsigned long line_number = 0;
+			while(pos < this->load_size && !this->load_cancel){
+				const char* part_end = binary || this->load_size - pos <= part_min_size ? nullptr : static_cast<const char*>(std::memchr(script + pos + part_min_size, '\n', this->load_size - pos - part_min_size));
+				const size_t part_size = part_end ? part_end + 1 - (script + pos) : this->load_size - pos;
+				parser.parse_script(data, script + pos, part_size, line_number);
+				line_number += std::count(script + pos, script + pos + part_size, '\n'),
+				pos += part_size;
+				commit(pos);
+			}
+		}catch(const std::exception& e){	// Script errors & allocation failures (events parsed before error stay)
+			commit(pos);
+			std::lock_guard<std::mutex> lock(this->load_mutex);
+			this->load_error = e.what();
+		}catch(...){
+			std::lock_guard<std::mutex> lock(this->load_mutex);
+			this->load_error = "Unknown error on script loading";
+		}
+		// Finish loading (events keep their own script lines)
+		{
+			std::lock_guard<std::mutex> lock(this->load_mutex);
+			this->load_done = true;
+		}
+		this->load_condition.notify_all(),
+		this->script_file.close();
+	}
+
+	float Renderer::load_progress(){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		return this->load_done || !this->load_size ? 1.0f : static_cast<float>(this->load_position) / this->load_size;
+	}
+
+	bool Renderer::loaded(std::string& error){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		error = this->load_error;
+		return this->load_done;
 	}
 
 	void Renderer::set_target(int width, int height, Colorspace format){
 		this->width = width,
 		this->height = height,
 		this->format = format,
-		this->renderer.set_size(::abs(width), ::abs(height)),
 		this->event_cache.clear();	// New positions by margin -> change!
 	}
 
+	void Renderer::reparse_event(Event& event, const std::string& line) throw(Exception){
+		Event new_event;
+		if(!this->parser.parse_event(this->script_data, line, new_event)){
+			std::vector<std::string> style_names = std::move(new_event.style_names);	// Invalid by style could become valid by style edit
+			new_event = Event(),
+			new_event.style_names = std::move(style_names);
+		}
+		new_event.source = line;
+		this->event_cache.remove(&event),
+		event = std::move(new_event);
+	}
+
+	void Renderer::reparse_style_users(const std::string& name){
+		// Collect style & styles which insert it
+		std::vector<std::string> names{name};
+		for(size_t names_i = 0; names_i < names.size(); ++names_i)
+			for(auto& style : this->script_data.styles)
+				if(style.second.find("\\\\" + names[names_i] + "\\\\") != std::string::npos && std::find(names.begin(), names.end(), style.first) == names.end())
+					names.push_back(style.first);
+		// Streamed events get parsed again by window
+		if(this->streaming){
+			this->clear_stream_window();
+			return;
+		}
+		// Reparse events which use them (failing ones become inactive)
+		for(Event& event : this->events)
+			if(std::find_first_of(event.style_names.begin(), event.style_names.end(), names.begin(), names.end()) != event.style_names.end())
+				try{
+					this->reparse_event(event, event.source);
+				}catch(Exception){
+					std::string source = std::move(event.source);
+					std::vector<std::string> style_names = std::move(event.style_names);
+					this->event_cache.remove(&event),
+					event = Event(),
+					event.source = std::move(source),
+					event.style_names = std::move(style_names);
+				}
+	}
+
+	Renderer::EventID Renderer::insert_event(const std::string& line, EventID before) throw(Exception){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		if(this->streaming)
+			throw Exception("Can't edit events of streamed script");
+		auto pos = this->events.end();
+		if(before){
+			auto id = this->event_ids.find(before);
+			if(id == this->event_ids.end())
+				throw Exception("Unknown event");
+			pos = id->second;
+		}
+		Event event;
+		this->reparse_event(event, line);
+		this->event_ids[this->next_event_id] = this->events.insert(pos, std::move(event));
+		return this->next_event_id++;
+	}
+
+	void Renderer::replace_event(EventID id, const std::string& line) throw(Exception){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		auto event = this->event_ids.find(id);
+		if(event == this->event_ids.end())
+			throw Exception("Unknown event");
+		this->reparse_event(*event->second, line);
+	}
+
+	void Renderer::remove_event(EventID id){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		auto event = this->event_ids.find(id);
+		if(event != this->event_ids.end())
+			this->event_cache.remove(&*event->second),
+			this->events.erase(event->second),
+			this->event_ids.erase(event);
+	}
+
+	void Renderer::set_style(const std::string& name, const std::string& content) throw(Exception){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		if(this->precompiled)
+			throw Exception("Can't edit styles of precompiled script");
+		this->script_data.styles[name] = content;
+		this->reparse_style_users(name);
+	}
+
+	void Renderer::remove_style(const std::string& name) throw(Exception){
+		std::lock_guard<std::mutex> lock(this->load_mutex);
+		if(this->precompiled)
+			throw Exception("Can't edit styles of precompiled script");
+		if(this->script_data.styles.erase(name))
+			this->reparse_style_users(name);
+	}
+
 	void Renderer::render(unsigned char* image, unsigned stride, unsigned long start_ms){
+		// Wait for background loading up to events of rendered time
+		std::unique_lock<std::mutex> lock(this->load_mutex);
+		this->load_condition.wait(lock, [this, start_ms]{return this->load_done || this->load_watermark > start_ms;});
 		// Flag for correct image flipping
 		bool image_flipped = false;
-		// Iterate through SSB events
-		for(Event& event : this->script_data.events)
+		// Draw SSB event
+		auto render_event = [&](Event& event){
 			// Active SSB event?
 			if(start_ms >= event.start_ms && start_ms < event.end_ms){
+				// Parse objects of lazy event on first activation (invalid one became inactive)
+				try{
+					this->parser.complete_event(this->script_data, event);
+				}catch(Exception){}
+				if(start_ms < event.start_ms || start_ms >= event.end_ms)
+					return;
 				// Flip image for right row alignment
 				if(this->height < 0 && !image_flipped)
 					GUtils::flip(image, ::abs(this->height), stride),
@@ -70,7 +355,7 @@ namespace SSB{
 					// Get scale for script->frame
 					double frame_scale_x, frame_scale_y;
 					get_2d_scale(::abs(this->width), ::abs(this->height), this->script_data.frame.width, this->script_data.frame.height, frame_scale_x, frame_scale_y);
-					// Collect render sizes
+					// Collect render sizes (backend image set to event's render area, overlay placed at area position)
 
 					// TODO
 
@@ -85,6 +370,15 @@ namespace SSB{
 						this->event_cache.add(&event, std::move(overlays));
 				}
 			}
+		};
+		// Iterate through SSB events (of current window while streaming)
+		if(this->streaming){
+			this->update_stream_window(start_ms);
+			for(auto& event : this->stream_events)
+				render_event(event.second);
+		}else
+			for(Event& event : this->events)
+				render_event(event);
 		// Image needs to get flipped back?
 		if(image_flipped)
 			GUtils::flip(image, ::abs(this->height), stride);
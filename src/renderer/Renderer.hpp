@@ -16,31 +16,88 @@ Permission is granted to anyone to use this software for any purpose, including
 
 #include "Overlay.hpp"
 #include "../renderer_backend/Renderer.hpp"
+#include "../parser/SSBParser.hpp"
 #include "../utils/memory.hpp"
+#include "../utils/io.hpp"
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <config.h>
 
 namespace SSB{
 	// Frontend renderer for SSB content
 	class Renderer{
+		public:
+			// Stable event identifier (loaded events get 1, 2, ... in script order, 0 is invalid)
+			using EventID = unsigned long;
+			// Script file loading (BACKGROUND returns immediately, rendering waits for needed events)
+			enum class Loading{BLOCKING, BACKGROUND};
 		private:
 			// Image data
 			int width, height;
 			Colorspace format;
 			// Backend renderer
 			Backend::Renderer renderer;
-			// Script data
+			// Script data (parsed lazily without warnings)
+			Parser parser;
 			Data script_data;
 			const std::string script_directory;
+			// Events in script order (stable addresses for cache) & by identifier
+			std::list<Event> events;
+			std::unordered_map<EventID, std::list<Event>::iterator> event_ids;
+			EventID next_event_id = 1;
+			bool precompiled = false;	// Events loaded without script lines, so no reparsing by style edits
+			// Script file memory (kept for streaming & background loading)
+			stdex::mapped_file script_file;
+			// Streaming of big script files (event lines indexed only, events of current time window parsed)
+			bool streaming = false;
+			std::vector<size_t> stream_order, stream_long_lines;	// Event lines by start time & ones longer than window
+			Time stream_window_start = 0, stream_window_end = 0;
+			std::map<size_t, Event> stream_events;	// Window events by event line (script order)
+			// Background loading of script file (events appended in parts, rendering waits for events until its time)
+			size_t load_size = 0;
+			size_t load_position = 0;
+			std::atomic<bool> load_cancel{false};
+			bool load_done = true;
+			Time load_watermark = 0;	// Earliest event start not loaded yet
+			std::string load_error;
+			std::mutex load_mutex;	// Guards events & script data while loading
+			std::condition_variable load_condition;
+			std::thread load_thread;
+			void load(Parser::Level level, Parser::Content content);
 			// Caches
 			stdex::Cache<Event*, std::vector<Overlay>, MAX_CACHE> event_cache;
 			stdex::Cache<std::string, GUtils::Image2D<>, MAX_CACHE> image_cache;
 			// Initialization
-			void init(int width, int height, Colorspace format, std::istream& data, bool warnings) throw(Exception);
+			void init(int width, int height, Colorspace format, std::istream& data) throw(Exception);
+			void init(int width, int height, Colorspace format, const char* data, size_t data_size) throw(Exception);
+			void index_events(std::vector<Event>& events);
+			void index_stream();
+			void update_stream_window(Time ms);
+			void clear_stream_window();
+			// Parse event line into existing event (invalid ones stay inactive)
+			void reparse_event(Event& event, const std::string& line) throw(Exception);
+			void reparse_style_users(const std::string& name);
 		public:
 			// Setters
-			Renderer(int width, int height, Colorspace format, const std::string& script, bool warnings) throw(Exception);
+			Renderer(int width, int height, Colorspace format, const std::string& script, bool warnings, Loading loading = Loading::BLOCKING) throw(Exception);
 			Renderer(int width, int height, Colorspace format, std::istream& data, bool warnings) throw(Exception);
+			Renderer(int width, int height, Colorspace format, const char* data, size_t data_size, bool warnings) throw(Exception);
+			~Renderer();
 			void set_target(int width, int height, Colorspace format);
+			// Loading state (progress in range 0-1, error of finished loading)
+			float load_progress();
+			bool loaded(std::string& error);
+			// Editing (event lines & styles, reparses & uncaches just affected events; no event lines while streaming, no styles of precompiled scripts)
+			EventID insert_event(const std::string& line, EventID before = 0) throw(Exception);
+			void replace_event(EventID id, const std::string& line) throw(Exception);
+			void remove_event(EventID id);
+			void set_style(const std::string& name, const std::string& content) throw(Exception);
+			void remove_style(const std::string& name) throw(Exception);
 			// Processing
 			void render(unsigned char* image, unsigned stride, unsigned long start_ms);
 			// No copy&move (-> backend renderer limitation)
@@ -14,8 +14,11 @@ Permission is granted to anyone to use this software for any purpose, including
 
 #include "public.h"
 #include "Renderer.hpp"
+#include "../parser/SSBParser.hpp"
+#include "../parser/SSBSerializer.hpp"
+#include "../utils/io.hpp"
+#include <fstream>
 #include <cstring>
-#include <sstream>
 #include <config.h>
 
 ssb_renderer ssb_create_renderer(int width, int height, char format, const char* script, char* warning){
@@ -35,7 +38,43 @@ ssb_renderer ssb_create_renderer(int width, int height, char format, const char*
 	}
 }
 
+ssb_renderer ssb_create_renderer_async(int width, int height, char format, const char* script, char* warning){
+	SSB::Colorspace rformat;
+	switch(format){
+		case SSB_BGR: rformat = SSB::Colorspace::BGR; break;
+		case SSB_BGRX: rformat = SSB::Colorspace::BGRX; break;
+		case SSB_BGRA: rformat = SSB::Colorspace::BGRA; break;
+		default: return 0;
+	}
+	try{
+		return new SSB::Renderer(width, height, rformat, script, warning != 0, SSB::Renderer::Loading::BACKGROUND);
+	}catch(SSB::Exception e){
+		if(warning)
+			strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+		return 0;
+	}
+}
+
+float ssb_get_load_progress(ssb_renderer renderer){
+	if(renderer)
+		return reinterpret_cast<SSB::Renderer*>(renderer)->load_progress();
+	return 0;
+}
+
+int ssb_is_loaded(ssb_renderer renderer, char* warning){
+	std::string error;
+	if(!renderer || !reinterpret_cast<SSB::Renderer*>(renderer)->loaded(error))
+		return 0;
+	if(warning && !error.empty())
+		strncpy(warning, error.c_str(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+	return 1;
+}
+
 ssb_renderer ssb_create_renderer_from_memory(int width, int height, char format, const char* data, char* warning){
+	return ssb_create_renderer_from_memory_n(width, height, format, data, data ? strlen(data) : 0, warning);
+}
+
+ssb_renderer ssb_create_renderer_from_memory_n(int width, int height, char format, const char* data, size_t size, char* warning){
 	SSB::Colorspace rformat;
 	switch(format){
 		case SSB_BGR: rformat = SSB::Colorspace::BGR; break;
@@ -43,9 +82,33 @@ ssb_renderer ssb_create_renderer_from_memory(int width, int height, char format,
 		case SSB_BGRA: rformat = SSB::Colorspace::BGRA; break;
 		default: return 0;
 	}
-	std::istringstream data_stream(data);
 	try{
-		return new SSB::Renderer(width, height, rformat, data_stream, warning != 0);
+		return new SSB::Renderer(width, height, rformat, data, size, warning != 0);
+	}catch(SSB::Exception e){
+		if(warning)
+			strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+		return 0;
+	}
+}
+
+int ssb_compile_script(const char* script, const char* binary, char* warning){
+	try{
+		if(!script || !binary)
+			throw SSB::Exception("Invalid filenames");
+		stdex::mapped_file file(script);
+		if(!file)
+			throw SSB::Exception("Couldn't open file \"" + std::string(script) + '\"');
+		SSB::Data data;
+		SSB::Parser(SSB::Parser::Level::ALL, 0).parse_script(data, file.data(), file.size());
+#if defined(_WIN32) && !defined(__MINGW32__)
+		std::ofstream out(Utf8::to_utf16(binary), std::ios::binary);	// stdex::fstream is wide there
+#else
+		stdex::fstream out(binary, std::ios::out | std::ios::binary | std::ios::trunc);
+#endif
+		if(!out)
+			throw SSB::Exception("Couldn't create file \"" + std::string(binary) + '\"');
+		SSB::Serializer::write(data, out);
+		return 1;
 	}catch(SSB::Exception e){
 		if(warning)
 			strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
@@ -66,6 +129,58 @@ void ssb_set_target(ssb_renderer renderer, int width, int height, char format){
 	}
 }
 
+unsigned long ssb_insert_event(ssb_renderer renderer, const char* line, unsigned long before, char* warning){
+	if(renderer && line)
+		try{
+			return reinterpret_cast<SSB::Renderer*>(renderer)->insert_event(line, before);
+		}catch(SSB::Exception e){
+			if(warning)
+				strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+		}
+	return 0;
+}
+
+int ssb_replace_event(ssb_renderer renderer, unsigned long id, const char* line, char* warning){
+	if(renderer && line)
+		try{
+			reinterpret_cast<SSB::Renderer*>(renderer)->replace_event(id, line);
+			return 1;
+		}catch(SSB::Exception e){
+			if(warning)
+				strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+		}
+	return 0;
+}
+
+void ssb_remove_event(ssb_renderer renderer, unsigned long id){
+	if(renderer)
+		reinterpret_cast<SSB::Renderer*>(renderer)->remove_event(id);
+}
+
+int ssb_set_style(ssb_renderer renderer, const char* name, const char* content, char* warning){
+	if(renderer && name && content)
+		try{
+			reinterpret_cast<SSB::Renderer*>(renderer)->set_style(name, content);
+			return 1;
+		}catch(SSB::Exception e){
+			if(warning)
+				strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+		}
+	return 0;
+}
+
+int ssb_remove_style(ssb_renderer renderer, const char* name, char* warning){
+	if(renderer && name)
+		try{
+			reinterpret_cast<SSB::Renderer*>(renderer)->remove_style(name);
+			return 1;
+		}catch(SSB::Exception e){
+			if(warning)
+				strncpy(warning, e.what(), SSB_WARNING_LENGTH-1)[SSB_WARNING_LENGTH-1] = '\0';
+		}
+	return 0;
+}
+
 void ssb_render(ssb_renderer renderer, unsigned char* image, unsigned pitch, unsigned long start_ms){
 	if(renderer)
 		reinterpret_cast<SSB::Renderer*>(renderer)->render(image, pitch, start_ms);
@@ -14,6 +14,8 @@ Permission is granted to anyone to use this software for any purpose, including
 
 #pragma once
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 	#define EXTERN_C extern "C"
 #else
@@ -36,11 +38,12 @@ typedef void* ssb_renderer;
 /// Frame colorspaces
 enum {SSB_BGR = 0, SSB_BGRX, SSB_BGRA};
 
-/// Maximal length for output warning of ssb_create_renderer and ssb_create_renderer_from_memory
+/// Maximal length for output warnings of functions
 #define SSB_WARNING_LENGTH 256
 
 /**
 Create renderer handle from file.
+Big files without warning output get streamed (just events around rendered time are kept in memory, no event editing).
 
 @param width Frame width
 @param height Frame height
@@ -51,6 +54,36 @@ Create renderer handle from file.
 */
 DLL_EXPORT ssb_renderer ssb_create_renderer(int width, int height, char format, const char* script, char* warning);
 
+/**
+Create renderer handle from file, parsing it on a background thread.
+Rendering waits just for events up to the rendered time (expects events roughly in time order).
+
+@param width Frame width
+@param height Frame height
+@param format Frame colorspace
+@param script SSB script to render
+@param warning Output warning, pointer can be zero
+@return Renderer handle or zero
+*/
+DLL_EXPORT ssb_renderer ssb_create_renderer_async(int width, int height, char format, const char* script, char* warning);
+
+/**
+Get loading progress of renderer script.
+
+@param renderer Renderer handle
+@return Progress in range 0-1
+*/
+DLL_EXPORT float ssb_get_load_progress(ssb_renderer renderer);
+
+/**
+Check whether renderer script finished loading.
+
+@param renderer Renderer handle
+@param warning Output warning of failed loading (events until error are available), pointer can be zero
+@return 1 if loaded, 0 if still loading
+*/
+DLL_EXPORT int ssb_is_loaded(ssb_renderer renderer, char* warning);
+
 /**
 Create renderer handle from memory.
 
@@ -63,6 +96,29 @@ Create renderer handle from memory.
 */
 DLL_EXPORT ssb_renderer ssb_create_renderer_from_memory(int width, int height, char format, const char* data, char* warning);
 
+/**
+Create renderer handle from memory with known size (binary scripts contain null bytes).
+
+@param width Frame width
+@param height Frame height
+@param format Frame colorspace
+@param data SSB data to render (text or binary script)
+@param size Data size in bytes
+@param warning Output warning, pointer can be zero
+@return Renderer handle or zero
+*/
+DLL_EXPORT ssb_renderer ssb_create_renderer_from_memory_n(int width, int height, char format, const char* data, size_t size, char* warning);
+
+/**
+Compile script file to binary script file for faster loading (detected automatically by renderer creation).
+
+@param script SSB script to compile
+@param binary Binary script to write
+@param warning Output warning, pointer can be zero
+@return 1 on success, 0 on failure
+*/
+DLL_EXPORT int ssb_compile_script(const char* script, const char* binary, char* warning);
+
 /**
 Set target frame information.
 
@@ -73,6 +129,58 @@ Set target frame information.
 */
 DLL_EXPORT void ssb_set_target(ssb_renderer renderer, int width, int height, char format);
 
+/**
+Insert event line into renderer script.
+Events loaded with the script got identifiers 1, 2, ... in script order.
+
+@param renderer Renderer handle
+@param line SSB event line (without line break)
+@param before Identifier of event to insert before or zero for appending
+@param warning Output warning, pointer can be zero
+@return Identifier of new event or zero
+*/
+DLL_EXPORT unsigned long ssb_insert_event(ssb_renderer renderer, const char* line, unsigned long before, char* warning);
+
+/**
+Replace event line in renderer script.
+
+@param renderer Renderer handle
+@param id Identifier of event to replace
+@param line SSB event line (without line break)
+@param warning Output warning, pointer can be zero
+@return 1 on success, 0 on failure
+*/
+DLL_EXPORT int ssb_replace_event(ssb_renderer renderer, unsigned long id, const char* line, char* warning);
+
+/**
+Remove event from renderer script.
+
+@param renderer Renderer handle
+@param id Identifier of event to remove
+*/
+DLL_EXPORT void ssb_remove_event(ssb_renderer renderer, unsigned long id);
+
+/**
+Insert or replace style in renderer script (events using it get updated; fails for precompiled scripts).
+
+@param renderer Renderer handle
+@param name Style name
+@param content Style content
+@param warning Output warning, pointer can be zero
+@return 1 on success, 0 on failure
+*/
+DLL_EXPORT int ssb_set_style(ssb_renderer renderer, const char* name, const char* content, char* warning);
+
+/**
+Remove style from renderer script (events using it get updated; fails for precompiled scripts).
+
+@param renderer Renderer handle
+@param name Style name
+@param warning Output warning, pointer can be zero
+@return 1 on success, 0 on failure
+*/
+DLL_EXPORT int ssb_remove_style(ssb_renderer renderer, const char* name, char* warning);
+
 /**
 Render on image.
 
@@ -0,0 +1,71 @@
+/*
+Project: SSBRenderer
+File: async.c
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef _WIN32
+	#define _POSIX_C_SOURCE 199309L	// nanosleep
+#endif
+#include "../public.h"
+#include <stdio.h>
+#ifdef _WIN32
+	#include <windows.h>
+	#define wait_ms(ms) Sleep(ms)
+#else
+	#include <time.h>
+	static void wait_ms(long ms){
+		const struct timespec duration = {ms / 1000, ms % 1000 * 1000000};
+		nanosleep(&duration, 0);
+	}
+#endif
+
+int main(){
+	// Write script file with many events & an error at the end
+	const char* filename = "ssbrenderer_async.ssb";
+	FILE* file = fopen(filename, "w");
+	if(!file){
+		puts("Couldn't write script file");
+		return 1;
+	}
+	fputs("#STYLES\nRed: {cl=FF0000}\n#EVENTS\n", file);
+	for(unsigned long ms = 0; ms < 1000000; ms += 10)
+		fprintf(file, "%lu:%02lu.%03lu-%lu:%02lu.%03lu|Red||{an=7;pos=0,0;gm=p}m 0 0 l 3 0 3 1 0 1\n", ms / 60000, ms / 1000 % 60, ms % 1000, (ms + 1000) / 60000, (ms + 1000) / 1000 % 60, (ms + 1000) % 1000);
+	fputs("0-1|Unknown||Invalid\n", file);
+	fclose(file);
+	// Create renderer & render while loading
+	char warning[SSB_WARNING_LENGTH] = {0};
+	ssb_renderer renderer = ssb_create_renderer_async(320, 240, SSB_BGR, filename, warning);
+	if(!renderer){
+		puts(warning);
+		remove(filename);
+		return 2;
+	}
+	unsigned char image[240*320*3] = {0};
+	ssb_render(renderer, image, 320*3, 500000);
+	// Wait for loading end with error
+	while(!ssb_is_loaded(renderer, warning))
+		wait_ms(10);
+	ssb_render(renderer, image, 320*3, 999999);
+	if(ssb_get_load_progress(renderer) != 1.0f || !warning[0]){
+		puts("Loading didn't finish with error");
+		ssb_free_renderer(renderer);
+		remove(filename);
+		return 3;
+	}
+	puts(warning);
+	// Destroy renderer while loading
+	ssb_free_renderer(ssb_create_renderer_async(320, 240, SSB_BGR, filename, 0));
+	ssb_free_renderer(renderer);
+	remove(filename);
+	// All correct
+	return 0;
+}
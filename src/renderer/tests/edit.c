@@ -0,0 +1,60 @@
+/*
+Project: SSBRenderer
+File: edit.c
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../public.h"
+#include <stdio.h>
+
+int main(){
+	// Script content
+	const char* data =
+	"#STYLES\n"
+	"Red: {cl=FF0000}\n"
+	"#EVENTS\n"
+	"0-1.0|Red||First\n"
+	"0-2.0|||Second";
+	// Create renderer
+	char warning[SSB_WARNING_LENGTH];
+	ssb_renderer renderer = ssb_create_renderer_from_memory(320, 240, SSB_BGR, data, warning);
+	if(!renderer){
+		puts(warning);
+		return 1;
+	}
+	// Edit events (loaded ones have identifiers 1 & 2)
+	unsigned long id = ssb_insert_event(renderer, "0-3.0|Red||Third", 2, warning);
+	if(id != 3){
+		puts(id ? "Unexpected event identifier" : warning);
+		return 2;
+	}
+	if(!ssb_replace_event(renderer, 1, "0-1.5|||{cl=00FF00}First", warning)){
+		puts(warning);
+		return 3;
+	}
+	if(ssb_replace_event(renderer, 4, "0-1|||Invalid", warning) || ssb_insert_event(renderer, "0-1|Unknown||Invalid", 0, warning)){
+		puts("Invalid edit accepted");
+		return 4;
+	}
+	ssb_remove_event(renderer, 2);
+	// Edit styles (reparses events using them)
+	if(!ssb_set_style(renderer, "Red", "{cl=FF0000;fs=30}", warning) || !ssb_remove_style(renderer, "Red", warning)){
+		puts(warning);
+		return 5;
+	}
+	// Render edited script
+	unsigned char image[240*320*3] = {0};
+	ssb_render(renderer, image, 320*3, 1000);
+	// Destroy renderer
+	ssb_free_renderer(renderer);
+	// All correct
+	return 0;
+}
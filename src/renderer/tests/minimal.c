@@ -41,6 +41,38 @@ int main(){
 		puts("Rendering failed (no results visible)");
 		return 2;
 	}
+	// Compile script & render binary script from memory
+	FILE* file = fopen("ssbrenderer_minimal.ssb", "w");
+	if(!file){
+		puts("Couldn't write script file");
+		return 3;
+	}
+	fputs(data, file);
+	fclose(file);
+	if(!ssb_compile_script("ssbrenderer_minimal.ssb", "ssbrenderer_minimal.ssbc", warning)){
+		puts(warning);
+		remove("ssbrenderer_minimal.ssb");
+		return 4;
+	}
+	char binary[4096];
+	file = fopen("ssbrenderer_minimal.ssbc", "rb");
+	const size_t binary_size = file ? fread(binary, 1, sizeof(binary), file) : 0;
+	if(file)
+		fclose(file);
+	remove("ssbrenderer_minimal.ssb"),
+	remove("ssbrenderer_minimal.ssbc");
+	renderer = ssb_create_renderer_from_memory_n(width, height, SSB_BGR, binary, binary_size, warning);
+	if(!renderer){
+		puts(warning);
+		return 5;
+	}
+	memset(image, 0, sizeof(image));
+	ssb_render(renderer, image, width*3, 1000);
+	ssb_free_renderer(renderer);
+	if(image[0] == 0){
+		puts("Rendering binary script failed (no results visible)");
+		return 6;
+	}
 	// All correct
 	return 0;
 }
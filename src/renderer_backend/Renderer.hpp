@@ -28,6 +28,8 @@ namespace Backend{
 			Renderer();
 			Renderer(unsigned width, unsigned height);
 			void set_size(unsigned width, unsigned height);
+			// Image as area of target frame (drawing in frame coordinates, so only area pixels cost; size set like by set_size)
+			void set_area(int x, int y, unsigned width, unsigned height);
 			// Free resources
 			~Renderer();
 			// No copy&move (-> resources limitation)
@@ -38,6 +40,8 @@ namespace Backend{
 			// Getters
 			unsigned width();
 			unsigned height();
+			int x();
+			int y();
 			void copy_image(unsigned char* image, unsigned padding);
 			// State
 			void reset();
@@ -62,8 +66,11 @@ namespace Backend{
 			void set_line_join(LineJoin join);
 			enum class LineCap{ROUND, SQUARE, FLAT};
 			void set_line_cap(LineCap cap);
-			void set_line_dash(double offset, std::vector<double> dashes);
+			void set_line_dash(double offset, const std::vector<double>& dashes);
 			void set_antialiasing(unsigned level);
+			// Draw into stencil (SET adds, UNSET removes coverage) or into image through stencil (INSIDE/OUTSIDE)
+			enum class StencilMode{OFF, SET, UNSET, INSIDE, OUTSIDE};
+			void set_stencil_mode(StencilMode mode);
 
 			std::string get_font_family();
 			float get_font_size();
@@ -89,6 +96,7 @@ namespace Backend{
 			double get_line_dash_offset();
 			std::vector<double> get_line_dash();
 			unsigned get_antialiasing();
+			StencilMode get_stencil_mode();
 			// Font/text analyzation
 			GUtils::Font::Metrics font_metrics();
 			double text_width(const std::string& text);
@@ -96,5 +104,9 @@ namespace Backend{
 			// Processing
 			void clear_image();
 			void clear_stencil();
+			// Draw path transformed by matrix (line width in image space) with fill color / line color
+			void fill_path(const std::vector<GUtils::PathSegment>& path);
+			void stroke_path(const std::vector<GUtils::PathSegment>& path);
+			void blur_image(float strength_h, float strength_v);
 	};
 }
@@ -14,7 +14,12 @@ Permission is granted to anyone to use this software for any purpose, including
 
 #include "Renderer.hpp"
 #include <cairo.h>
+#include <cmath>
 #include <memory>
+#include <functional>
+
+// Curve flattening tolerance (angle) for deformed paths
+static constexpr double flatten_tolerance = 0.05;
 
 // Cairo surface+context destroyer
 auto cairo_destroyer = [](cairo_t* ctx){
@@ -25,9 +30,14 @@ auto cairo_destroyer = [](cairo_t* ctx){
 
 // Renderer private data
 using cairo_t_safe = std::unique_ptr<cairo_t, std::function<void(cairo_t*)>>;
+using cairo_surface_t_safe = std::unique_ptr<cairo_surface_t, std::function<void(cairo_surface_t*)>>;
 struct InstanceData{
-	// Buffers
-	cairo_t_safe image, stencil;
+	// Buffers (allocated for largest size yet, context draws on used area; stencil covers touched area only)
+	cairo_surface_t_safe image_buffer;
+	cairo_t_safe image;
+	GUtils::SpanMask stencil;
+	int x, y;	// Area position in frame
+	unsigned width, height;
 	// State
 	GUtils::Font font;
 	std::string deform_x, deform_y;
@@ -39,16 +49,126 @@ struct InstanceData{
 	std::string texture_filename;
 	double texture_x, texture_y;
 	cairo_extend_t texture_wrap;
-	// Rest in cairo context or extern
+	double line_width;
+	cairo_line_join_t line_join;
+	cairo_line_cap_t line_cap;
+	double dash_offset;
+	std::vector<double> dashes;
+	cairo_antialias_t antialias;
+	Backend::Renderer::StencilMode stencil_mode;
+	// State changes not applied to cairo context yet (by draw calls)
+	unsigned char image_dirty;
 };
 #define INST_DATA reinterpret_cast<InstanceData*>(this->data)
 
+// Cairo context state flags
+enum : unsigned char{
+	LINE_WIDTH = 0x1, LINE_JOIN = 0x2, LINE_CAP = 0x4, LINE_DASH = 0x8, ANTIALIAS = 0x10,
+	ALL_STATE = 0x1f
+};
+
+// Remember state change for context (if value changed)
+template<typename T>
+static inline void set_state(InstanceData* inst, T& target, const T& value, unsigned char flag){
+	if(target != value)
+		target = value,
+		inst->image_dirty |= flag;
+}
+
+// Apply changed state to context before drawing
+static void apply_state(InstanceData* inst, cairo_t* ctx, unsigned char& dirty){
+	if(dirty & LINE_WIDTH)
+		cairo_set_line_width(ctx, inst->line_width);
+	if(dirty & LINE_JOIN)
+		cairo_set_line_join(ctx, inst->line_join);
+	if(dirty & LINE_CAP)
+		cairo_set_line_cap(ctx, inst->line_cap);
+	if(dirty & LINE_DASH)
+		cairo_set_dash(ctx, inst->dashes.data(), inst->dashes.size(), inst->dash_offset);
+	if(dirty & ANTIALIAS)
+		cairo_set_antialias(ctx, inst->antialias);
+	dirty = 0;
+}
+
+// Replace cairo path by deformed & transformed one
+static void set_cairo_path(InstanceData* inst, cairo_t* ctx, const std::vector<GUtils::PathSegment>& path){
+	// Deform in path space (cached, flattened before so curves bend too)
+	std::vector<GUtils::PathSegment> transformed_path(inst->deform_x.empty() && inst->deform_y.empty() ? path :
+		*GUtils::path_deform_cached(path, flatten_tolerance, inst->deform_x, inst->deform_y, inst->deform_progress));
+	GUtils::path_transform(transformed_path, inst->matrix);
+	// Frame to image area
+	for(GUtils::PathSegment& segment : transformed_path)
+		segment.x -= inst->x,
+		segment.y -= inst->y;
+	cairo_new_path(ctx);
+	for(size_t i = 0; i < transformed_path.size(); ++i)
+		switch(transformed_path[i].type){
+			case GUtils::PathSegment::Type::MOVE: cairo_move_to(ctx, transformed_path[i].x, transformed_path[i].y); break;
+			case GUtils::PathSegment::Type::LINE: cairo_line_to(ctx, transformed_path[i].x, transformed_path[i].y); break;
+			case GUtils::PathSegment::Type::CURVE:
+				if(i+2 < transformed_path.size())
+					cairo_curve_to(ctx, transformed_path[i].x, transformed_path[i].y, transformed_path[i+1].x, transformed_path[i+1].y, transformed_path[i+2].x, transformed_path[i+2].y),
+					i += 2;
+				break;
+			case GUtils::PathSegment::Type::CLOSE: cairo_close_path(ctx); break;
+		}
+}
+
+// Draw path into stencil or with color through stencil (coverage rasterized by cairo like unstenciled drawing)
+static void stencil_path(InstanceData* inst, const std::vector<GUtils::PathSegment>& path, bool stroke, const std::array<double,4>& color){
+	// Pixel-aligned path extents in image
+	cairo_t* image_context = inst->image.get();
+	apply_state(inst, image_context, inst->image_dirty),
+	set_cairo_path(inst, image_context, path),
+	cairo_set_fill_rule(image_context, CAIRO_FILL_RULE_WINDING);
+	double x0, y0, x1, y1;
+	if(stroke)
+		cairo_stroke_extents(image_context, &x0, &y0, &x1, &y1);
+	else
+		cairo_fill_extents(image_context, &x0, &y0, &x1, &y1);
+	const int mask_x = std::max(static_cast<int>(std::floor(x0)), 0), mask_y = std::max(static_cast<int>(std::floor(y0)), 0),
+		width = std::min(static_cast<int>(std::ceil(x1)), static_cast<int>(inst->width)) - mask_x,
+		height = std::min(static_cast<int>(std::ceil(y1)), static_cast<int>(inst->height)) - mask_y;
+	if(width <= 0 || height <= 0)
+		return;
+	// Path coverage into mask by cairo
+	GUtils::Image2D<> mask(width, height, cairo_format_stride_for_width(CAIRO_FORMAT_A8, width));
+	cairo_surface_t* mask_surface = cairo_image_surface_create_for_data(mask.get_data(), CAIRO_FORMAT_A8, width, height, mask.get_stride());
+	cairo_t* mask_context = cairo_create(mask_surface);
+	cairo_path_t* image_path = cairo_copy_path(image_context);
+	unsigned char mask_dirty = ALL_STATE;
+	apply_state(inst, mask_context, mask_dirty),
+	cairo_set_fill_rule(mask_context, CAIRO_FILL_RULE_WINDING),
+	cairo_translate(mask_context, -mask_x, -mask_y),
+	cairo_append_path(mask_context, image_path),
+	cairo_path_destroy(image_path);
+	if(stroke)
+		cairo_stroke(mask_context);
+	else
+		cairo_fill(mask_context);
+	cairo_destroy(mask_context),
+	cairo_surface_flush(mask_surface);
+	// Combine with stencil or reduce to stencil & draw with color through mask
+	switch(inst->stencil_mode){
+		case Backend::Renderer::StencilMode::SET: inst->stencil.unite(mask, mask_x, mask_y); break;
+		case Backend::Renderer::StencilMode::UNSET: inst->stencil.subtract(mask, mask_x, mask_y); break;
+		default:
+			inst->stencil.clip(mask, mask_x, mask_y, inst->stencil_mode == Backend::Renderer::StencilMode::INSIDE),
+			cairo_surface_mark_dirty(mask_surface),
+			cairo_set_operator(image_context, CAIRO_OPERATOR_OVER),
+			cairo_set_source_rgba(image_context, color[0], color[1], color[2], color[3]),
+			cairo_mask_surface(image_context, mask_surface, mask_x, mask_y);
+			break;
+	}
+	cairo_surface_destroy(mask_surface);
+}
+
 namespace Backend{
 	Renderer::Renderer() : Renderer::Renderer(1, 1){}
 
 	Renderer::Renderer(unsigned width, unsigned height){
 		this->data = new InstanceData{
-			cairo_t_safe(nullptr, cairo_destroyer),
+			cairo_surface_t_safe(nullptr, cairo_surface_destroy),
 			cairo_t_safe(nullptr, cairo_destroyer)
 		},
 		this->set_size(width, height),
@@ -56,8 +176,27 @@ namespace Backend{
 	}
 
 	void Renderer::set_size(unsigned width, unsigned height){
-		INST_DATA->image.reset(cairo_create(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height))),
-		INST_DATA->stencil.reset(cairo_create(cairo_image_surface_create(CAIRO_FORMAT_A8, width, height)));
+		// Grow buffers if needed (smaller sizes reuse them)
+		cairo_surface_t* image_buffer = INST_DATA->image_buffer.get();
+		if(!image_buffer || static_cast<int>(width) > cairo_image_surface_get_width(image_buffer) || static_cast<int>(height) > cairo_image_surface_get_height(image_buffer)){
+			const int buffer_width = image_buffer ? std::max(static_cast<int>(width), cairo_image_surface_get_width(image_buffer)) : width,
+				buffer_height = image_buffer ? std::max(static_cast<int>(height), cairo_image_surface_get_height(image_buffer)) : height;
+			INST_DATA->image_buffer.reset(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, buffer_width, buffer_height));
+		}
+		// Context on used buffer area
+		INST_DATA->image.reset(cairo_create(cairo_surface_create_for_rectangle(INST_DATA->image_buffer.get(), 0, 0, width, height))),
+		INST_DATA->image_dirty = ALL_STATE,
+		INST_DATA->width = width,
+		INST_DATA->height = height;
+		// Remove content of previous usage
+		this->clear_image(),
+		this->clear_stencil();
+	}
+
+	void Renderer::set_area(int x, int y, unsigned width, unsigned height){
+		INST_DATA->x = x,
+		INST_DATA->y = y,
+		this->set_size(width, height);
 	}
 
 	Renderer::~Renderer(){
@@ -65,17 +204,25 @@ namespace Backend{
 	}
 
 	unsigned Renderer::width(){
-		return cairo_image_surface_get_width(cairo_get_target(INST_DATA->image.get()));
+		return INST_DATA->width;
 	}
 
 	unsigned Renderer::height(){
-		return cairo_image_surface_get_height(cairo_get_target(INST_DATA->image.get()));
+		return INST_DATA->height;
+	}
+
+	int Renderer::x(){
+		return INST_DATA->x;
+	}
+
+	int Renderer::y(){
+		return INST_DATA->y;
 	}
 
 	void Renderer::copy_image(unsigned char* image, unsigned padding){
 		// Get source data
-		cairo_surface_t* image_surface = cairo_get_target(INST_DATA->image.get());
-		const int rowsize = cairo_image_surface_get_width(image_surface) << 2, stride = cairo_image_surface_get_stride(image_surface), height = cairo_image_surface_get_height(image_surface);
+		cairo_surface_t* image_surface = INST_DATA->image_buffer.get();
+		const int rowsize = INST_DATA->width << 2, stride = cairo_image_surface_get_stride(image_surface), height = INST_DATA->height;
 		cairo_surface_flush(image_surface);
 		const unsigned char* src_data = cairo_image_surface_get_data(image_surface);
 		// Copy source rows to destination
@@ -95,16 +242,16 @@ namespace Backend{
 		INST_DATA->line_color = {0, 0, 0, 1},
 		INST_DATA->texture_filename.clear(),
 		INST_DATA->texture_x = INST_DATA->texture_y = 0,
-		INST_DATA->texture_wrap = CAIRO_EXTEND_NONE;
-		// Get cairo contexts
-		cairo_t* image_ctx = INST_DATA->image.get(),
-			*stencil_ctx = INST_DATA->stencil.get();
-		// Reset cairo state
-		cairo_set_line_width(image_ctx, 4), cairo_set_line_width(stencil_ctx, 4),	// Line width = 2x border width
-		cairo_set_line_join(image_ctx, CAIRO_LINE_JOIN_ROUND), cairo_set_line_join(stencil_ctx, CAIRO_LINE_JOIN_ROUND),
-		cairo_set_line_cap(image_ctx, CAIRO_LINE_CAP_ROUND), cairo_set_line_cap(stencil_ctx, CAIRO_LINE_CAP_ROUND),
-		cairo_set_dash(image_ctx, nullptr, 0, 0), cairo_set_dash(stencil_ctx, nullptr, 0, 0),
-		cairo_set_antialias(image_ctx, CAIRO_ANTIALIAS_BEST), cairo_set_antialias(stencil_ctx, CAIRO_ANTIALIAS_BEST);
+		INST_DATA->texture_wrap = CAIRO_EXTEND_NONE,
+		INST_DATA->line_width = 4,	// Line width = 2x border width
+		INST_DATA->line_join = CAIRO_LINE_JOIN_ROUND,
+		INST_DATA->line_cap = CAIRO_LINE_CAP_ROUND,
+		INST_DATA->dash_offset = 0,
+		INST_DATA->dashes.clear(),
+		INST_DATA->antialias = CAIRO_ANTIALIAS_BEST,
+		INST_DATA->stencil_mode = Renderer::StencilMode::OFF,
+		// Cairo context gets state on next drawing
+		INST_DATA->image_dirty = ALL_STATE;
 	}
 
 	void Renderer::set_font(const std::string& family, float size, bool bold, bool italic, bool underline, bool strikeout, double spacing){
@@ -159,55 +306,36 @@ namespace Backend{
 	}
 
 	void Renderer::set_line_width(double width){
-		cairo_set_line_width(INST_DATA->image.get(), width), cairo_set_line_width(INST_DATA->stencil.get(), width);
+		set_state(INST_DATA, INST_DATA->line_width, width, LINE_WIDTH);
 	}
 
 	void Renderer::set_line_join(Renderer::LineJoin join){
 		switch(join){
-			case Renderer::LineJoin::MITER:
-				cairo_set_line_join(INST_DATA->image.get(), CAIRO_LINE_JOIN_MITER),
-				cairo_set_line_join(INST_DATA->stencil.get(), CAIRO_LINE_JOIN_MITER);
-				break;
-			case Renderer::LineJoin::ROUND:
-				cairo_set_line_join(INST_DATA->image.get(), CAIRO_LINE_JOIN_ROUND),
-				cairo_set_line_join(INST_DATA->stencil.get(), CAIRO_LINE_JOIN_ROUND);
-				break;
-			case Renderer::LineJoin::BEVEL:
-				cairo_set_line_join(INST_DATA->image.get(), CAIRO_LINE_JOIN_BEVEL),
-				cairo_set_line_join(INST_DATA->stencil.get(), CAIRO_LINE_JOIN_BEVEL);
-				break;
+			case Renderer::LineJoin::MITER: set_state(INST_DATA, INST_DATA->line_join, CAIRO_LINE_JOIN_MITER, LINE_JOIN); break;
+			case Renderer::LineJoin::ROUND: set_state(INST_DATA, INST_DATA->line_join, CAIRO_LINE_JOIN_ROUND, LINE_JOIN); break;
+			case Renderer::LineJoin::BEVEL: set_state(INST_DATA, INST_DATA->line_join, CAIRO_LINE_JOIN_BEVEL, LINE_JOIN); break;
 		}
 	}
 
 	void Renderer::set_line_cap(Renderer::LineCap cap){
 		switch(cap){
-			case Renderer::LineCap::FLAT:
-				cairo_set_line_cap(INST_DATA->image.get(), CAIRO_LINE_CAP_BUTT),
-				cairo_set_line_cap(INST_DATA->stencil.get(), CAIRO_LINE_CAP_BUTT);
-				break;
-			case Renderer::LineCap::ROUND:
-				cairo_set_line_cap(INST_DATA->image.get(), CAIRO_LINE_CAP_ROUND),
-				cairo_set_line_cap(INST_DATA->stencil.get(), CAIRO_LINE_CAP_ROUND);
-				break;
-			case Renderer::LineCap::SQUARE:
-				cairo_set_line_cap(INST_DATA->image.get(), CAIRO_LINE_CAP_SQUARE),
-				cairo_set_line_cap(INST_DATA->stencil.get(), CAIRO_LINE_CAP_SQUARE);
-				break;
+			case Renderer::LineCap::FLAT: set_state(INST_DATA, INST_DATA->line_cap, CAIRO_LINE_CAP_BUTT, LINE_CAP); break;
+			case Renderer::LineCap::ROUND: set_state(INST_DATA, INST_DATA->line_cap, CAIRO_LINE_CAP_ROUND, LINE_CAP); break;
+			case Renderer::LineCap::SQUARE: set_state(INST_DATA, INST_DATA->line_cap, CAIRO_LINE_CAP_SQUARE, LINE_CAP); break;
 		}
 	}
 
-	void Renderer::set_line_dash(double offset, std::vector<double> dashes){
-		cairo_set_dash(INST_DATA->image.get(), dashes.data(), dashes.size(), offset),
-		cairo_set_dash(INST_DATA->stencil.get(), dashes.data(), dashes.size(), offset);
+	void Renderer::set_line_dash(double offset, const std::vector<double>& dashes){
+		set_state(INST_DATA, INST_DATA->dash_offset, offset, LINE_DASH),
+		set_state(INST_DATA, INST_DATA->dashes, dashes, LINE_DASH);
 	}
 
 	void Renderer::set_antialiasing(unsigned level){
-		if(level)
-			cairo_set_antialias(INST_DATA->image.get(), CAIRO_ANTIALIAS_BEST),
-			cairo_set_antialias(INST_DATA->stencil.get(), CAIRO_ANTIALIAS_BEST);
-		else
-			cairo_set_antialias(INST_DATA->image.get(), CAIRO_ANTIALIAS_NONE),
-			cairo_set_antialias(INST_DATA->stencil.get(), CAIRO_ANTIALIAS_NONE);
+		set_state(INST_DATA, INST_DATA->antialias, level ? CAIRO_ANTIALIAS_BEST : CAIRO_ANTIALIAS_NONE, ANTIALIAS);
+	}
+
+	void Renderer::set_stencil_mode(Renderer::StencilMode mode){
+		INST_DATA->stencil_mode = mode;
 	}
 
 	std::string Renderer::get_font_family(){
@@ -289,11 +417,11 @@ namespace Backend{
 	}
 
 	double Renderer::get_line_width(){
-		return cairo_get_line_width(INST_DATA->image.get());
+		return INST_DATA->line_width;
 	}
 
 	Renderer::LineJoin Renderer::get_line_join(){
-		switch(cairo_get_line_join(INST_DATA->image.get())){
+		switch(INST_DATA->line_join){
 			case CAIRO_LINE_JOIN_MITER: return Renderer::LineJoin::MITER;
 			case CAIRO_LINE_JOIN_ROUND: return Renderer::LineJoin::ROUND;
 			case CAIRO_LINE_JOIN_BEVEL: return Renderer::LineJoin::BEVEL;
@@ -302,7 +430,7 @@ namespace Backend{
 	}
 
 	Renderer::LineCap Renderer::get_line_cap(){
-		switch(cairo_get_line_cap(INST_DATA->image.get())){
+		switch(INST_DATA->line_cap){
 			case CAIRO_LINE_CAP_BUTT: return Renderer::LineCap::FLAT;
 			case CAIRO_LINE_CAP_ROUND: return Renderer::LineCap::ROUND;
 			case CAIRO_LINE_CAP_SQUARE: return Renderer::LineCap::SQUARE;
@@ -311,19 +439,19 @@ namespace Backend{
 	}
 
 	double Renderer::get_line_dash_offset(){
-		double offset;
-		cairo_get_dash(INST_DATA->image.get(), NULL, &offset);
-		return offset;
+		return INST_DATA->dash_offset;
 	}
 
 	std::vector<double> Renderer::get_line_dash(){
-		std::vector<double> dashes(cairo_get_dash_count(INST_DATA->image.get()));
-		cairo_get_dash(INST_DATA->image.get(), dashes.data(), NULL);
-		return dashes;
+		return INST_DATA->dashes;
 	}
 
 	unsigned Renderer::get_antialiasing(){
-		return cairo_get_antialias(INST_DATA->image.get()) == CAIRO_ANTIALIAS_BEST ? 8 : 0;
+		return INST_DATA->antialias == CAIRO_ANTIALIAS_BEST ? 8 : 0;
+	}
+
+	Renderer::StencilMode Renderer::get_stencil_mode(){
+		return INST_DATA->stencil_mode;
 	}
 
 	GUtils::Font::Metrics Renderer::font_metrics(){
@@ -345,9 +473,38 @@ namespace Backend{
 	}
 
 	void Renderer::clear_stencil(){
-		cairo_t* stencil_context = INST_DATA->stencil.get();
-		cairo_set_operator(stencil_context, CAIRO_OPERATOR_SOURCE),
-		cairo_set_source_rgba(stencil_context, 0, 0, 0, 0),
-		cairo_paint(stencil_context);
+		INST_DATA->stencil.clear();
+	}
+
+	void Renderer::fill_path(const std::vector<GUtils::PathSegment>& path){
+		if(INST_DATA->stencil_mode != Renderer::StencilMode::OFF)
+			return stencil_path(INST_DATA, path, false, INST_DATA->fill_color.front());
+		cairo_t* image_context = INST_DATA->image.get();
+		apply_state(INST_DATA, image_context, INST_DATA->image_dirty),
+		set_cairo_path(INST_DATA, image_context, path);
+		const std::array<double,4>& color = INST_DATA->fill_color.front();
+		cairo_set_operator(image_context, CAIRO_OPERATOR_OVER),
+		cairo_set_fill_rule(image_context, CAIRO_FILL_RULE_WINDING),
+		cairo_set_source_rgba(image_context, color[0], color[1], color[2], color[3]),
+		cairo_fill(image_context);
+	}
+
+	void Renderer::stroke_path(const std::vector<GUtils::PathSegment>& path){
+		if(INST_DATA->stencil_mode != Renderer::StencilMode::OFF)
+			return stencil_path(INST_DATA, path, true, INST_DATA->line_color);
+		cairo_t* image_context = INST_DATA->image.get();
+		apply_state(INST_DATA, image_context, INST_DATA->image_dirty),
+		set_cairo_path(INST_DATA, image_context, path);
+		const std::array<double,4>& color = INST_DATA->line_color;
+		cairo_set_operator(image_context, CAIRO_OPERATOR_OVER),
+		cairo_set_source_rgba(image_context, color[0], color[1], color[2], color[3]),
+		cairo_stroke(image_context);
+	}
+
+	void Renderer::blur_image(float strength_h, float strength_v){
+		cairo_surface_t* image_surface = INST_DATA->image_buffer.get();
+		cairo_surface_flush(image_surface),
+		GUtils::blur(cairo_image_surface_get_data(image_surface), INST_DATA->width, INST_DATA->height, cairo_image_surface_get_stride(image_surface), GUtils::ColorDepth::X4, strength_h, strength_v),
+		cairo_surface_mark_dirty(image_surface);
 	}
 }
@@ -12,102 +12,827 @@ Permission is granted to anyone to use this software for any purpose, including
     3. This notice may not be removed or altered from any source distribution.
 */
 
-#error "Hardware renderer not implemented yet!"
-
 #include "Renderer.hpp"
-#include <glfw3.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
 #include <png.h>
-
 #include <thread>
 #include <mutex>
 #include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
 
-// Manage GL context by thread & references
+// Manage offscreen GL context by thread & references (no window or surface)
 struct Context{
-	std::unique_ptr<GLFWwindow,std::function<void(GLFWwindow*)>> window;
+	EGLContext context;
 	unsigned ref_count;
 };
+static EGLDisplay display = EGL_NO_DISPLAY;
 static std::unordered_map<std::thread::id,Context> contexts;
 static std::mutex contexts_mutex;
 
-namespace Backend{
-	Renderer::Renderer(){
-		// Update contexts for new creation
-		{
-			std::unique_lock<std::mutex> lock(contexts_mutex);
-			auto thread_id = std::this_thread::get_id();
-			if(contexts.count(thread_id))
-				++contexts[thread_id].ref_count;
-			else{
-				// Initialize GLFW on first context
-				if(contexts.empty())
-					glfwInit();
-				// Create context
-				GLFWwindow* window = glfwCreateWindow(1, 1, "Dummy", NULL, NULL);
-				glfwHideWindow(window);
-				glfwMakeContextCurrent(window);
-				contexts[thread_id] = {
-					std::unique_ptr<GLFWwindow,std::function<void(GLFWwindow*)>>(window, [](GLFWwindow* w){glfwMakeContextCurrent(NULL); glfwDestroyWindow(w);}),
-					1
-				};
-			}
+static EGLDisplay open_display(){
+	EGLDisplay display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+	// Prefer display without any window system (works headless & on software rasterizers)
+	auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+	if(get_platform_display)
+		display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+#endif
+	if(display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if(display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+		throw std::runtime_error("Couldn't initialize EGL display");
+	return display;
+}
+
+static void acquire_context(){
+	std::unique_lock<std::mutex> lock(contexts_mutex);
+	auto thread_id = std::this_thread::get_id();
+	if(contexts.count(thread_id))
+		++contexts[thread_id].ref_count;
+	else{
+		// Initialize EGL on first context
+		if(contexts.empty())
+			display = open_display();
+		// Create OpenGL ES 3 context without surface
+		const EGLint config_attribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_SURFACE_TYPE, 0, EGL_NONE},
+			context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+		EGLConfig config = nullptr;
+		EGLint configs_n = 0;
+		EGLContext context = eglBindAPI(EGL_OPENGL_ES_API) && eglChooseConfig(display, config_attribs, &config, 1, &configs_n) && configs_n ?
+			eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs) : EGL_NO_CONTEXT;
+		if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)){
+			if(context != EGL_NO_CONTEXT)
+				eglDestroyContext(display, context);
+			if(contexts.empty())
+				eglTerminate(display),
+				display = EGL_NO_DISPLAY;
+			throw std::runtime_error("Couldn't create surfaceless OpenGL ES 3 context");
 		}
+		contexts[thread_id] = {context, 1};
+	}
+}
+
+static void release_context(){
+	std::unique_lock<std::mutex> lock(contexts_mutex);
+	auto thread_id = std::this_thread::get_id();
+	if(--contexts[thread_id].ref_count == 0){
+		// Destroy context
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT),
+		eglDestroyContext(display, contexts[thread_id].context),
+		eglReleaseThread(),
+		contexts.erase(thread_id);
+		// Terminate EGL on non-remaining context
+		if(contexts.empty())
+			eglTerminate(display),
+			display = EGL_NO_DISPLAY;
+	}
+}
 
-		// TODO: create resources
+// Shader sources (coordinates in image pixels, row 0 at top = first memory row)
+static const char* const vertex_shader_source =
+	"#version 300 es\n"
+	"layout(location = 0) in vec2 position;\n"
+	"uniform vec2 size;\n"
+	"void main(){\n"
+	"	gl_Position = vec4(position / size * 2.0 - 1.0, 0.0, 1.0);\n"
+	"}\n";
+static const char* const fill_shader_source =
+	"#version 300 es\n"
+	"precision highp float;\n"
+	"uniform vec4 colors[4];\n"	// Top-left, top-right, bottom-right, bottom-left
+	"uniform vec4 box;\n"	// Gradient area: min x+y, max x+y
+	"uniform bool textured;\n"
+	"uniform sampler2D tex;\n"
+	"uniform vec2 tex_offset;\n"
+	"uniform int tex_wrap;\n"	// Backend::Renderer::TexWrap
+	"out vec4 frag_color;\n"
+	"void main(){\n"
+	"	vec2 pos = gl_FragCoord.xy, t = clamp((pos - box.xy) / max(box.zw - box.xy, vec2(1e-6)), 0.0, 1.0);\n"
+	"	vec4 color = mix(mix(colors[0], colors[1], t.x), mix(colors[3], colors[2], t.x), t.y);\n"
+	"	if(textured){\n"
+	"		vec2 uv = (pos - tex_offset) / vec2(textureSize(tex, 0));\n"
+	"		if(tex_wrap == 0 && (any(lessThan(uv, vec2(0.0))) || any(greaterThanEqual(uv, vec2(1.0)))))\n"
+	"			color = vec4(0.0);\n"
+	"		else\n"
+	"			color *= texture(tex, tex_wrap == 1 ? fract(uv) : (tex_wrap == 2 ? 1.0 - abs(mod(uv, 2.0) - 1.0) : uv));\n"
+	"	}\n"
+	"	frag_color = vec4(color.rgb * color.a, color.a);\n"
+	"}\n";
+static const char* const composite_shader_source =
+	"#version 300 es\n"
+	"precision mediump float;\n"
+	"uniform sampler2D layer;\n"
+	"uniform sampler2D stencil;\n"
+	"uniform int stencil_mode;\n"	// Backend::Renderer::StencilMode
+	"out vec4 frag_color;\n"
+	"void main(){\n"
+	"	ivec2 pos = ivec2(gl_FragCoord.xy);\n"
+	"	vec4 color = texelFetch(layer, pos, 0);\n"
+	"	if(stencil_mode == 1 || stencil_mode == 2)\n"	// Coverage into stencil
+	"		frag_color = vec4(color.a);\n"
+	"	else{\n"
+	"		if(stencil_mode == 3)\n"
+	"			color *= texelFetch(stencil, pos, 0).r;\n"
+	"		else if(stencil_mode == 4)\n"
+	"			color *= 1.0 - texelFetch(stencil, pos, 0).r;\n"
+	"		frag_color = color.%s;\n"	// Swizzle to byte order of native ARGB32
+	"	}\n"
+	"}\n";
+static const char* const blur_shader_source =
+	"#version 300 es\n"
+	"precision highp float;\n"
+	"uniform sampler2D source;\n"
+	"uniform sampler2D kernel;\n"	// Weights in one row, radius = width / 2
+	"uniform ivec2 direction;\n"
+	"uniform ivec2 area;\n"	// Used image size
+	"out vec4 frag_color;\n"
+	"void main(){\n"
+	"	ivec2 pos = ivec2(gl_FragCoord.xy);\n"
+	"	int radius = textureSize(kernel, 0).x >> 1;\n"
+	"	vec4 sum = vec4(0.0);\n"
+	"	for(int i = -radius; i <= radius; ++i){\n"
+	"		ivec2 sample_pos = pos + direction * i;\n"
+	"		if(all(greaterThanEqual(sample_pos, ivec2(0))) && all(lessThan(sample_pos, area)))\n"
+	"			sum += texelFetch(source, sample_pos, 0) * texelFetch(kernel, ivec2(i + radius, 0), 0).r;\n"
+	"	}\n"
+	"	frag_color = sum;\n"
+	"}\n";
+
+static GLuint compile_shader(GLenum type, const char* source){
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr),
+	glCompileShader(shader);
+	GLint status;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if(!status){
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), nullptr, log),
+		glDeleteShader(shader);
+		throw std::runtime_error(std::string("Couldn't compile shader: ") + log);
+	}
+	return shader;
+}
+
+static GLuint create_program(const char* fragment_source){
+	GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_shader_source),
+		fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source),
+		program = glCreateProgram();
+	glAttachShader(program, vertex_shader),
+	glAttachShader(program, fragment_shader),
+	glLinkProgram(program),
+	glDeleteShader(vertex_shader),
+	glDeleteShader(fragment_shader);
+	GLint status;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if(!status){
+		glDeleteProgram(program);
+		throw std::runtime_error("Couldn't link shader program");
+	}
+	return program;
+}
+
+static GLuint create_texture(GLint format, GLsizei width, GLsizei height, GLenum data_format, GLenum data_type, const void* data, GLint filter){
+	GLuint texture;
+	glGenTextures(1, &texture),
+	glBindTexture(GL_TEXTURE_2D, texture),
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter),
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter),
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE),
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE),
+	glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, data_format, data_type, data);
+	return texture;
+}
+
+static GLuint create_framebuffer(GLuint texture){
+	GLuint framebuffer;
+	glGenFramebuffers(1, &framebuffer),
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer),
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	return framebuffer;
+}
+
+// Load PNG file as RGBA texture (0 on failure)
+static GLuint load_texture(const std::string& filename){
+	png_image image;
+	std::memset(&image, 0, sizeof(image)),
+	image.version = PNG_IMAGE_VERSION;
+	if(!png_image_begin_read_from_file(&image, filename.c_str()))
+		return 0;
+	image.format = PNG_FORMAT_RGBA;
+	std::vector<unsigned char> data(PNG_IMAGE_SIZE(image));
+	if(!png_image_finish_read(&image, nullptr, data.data(), 0, nullptr)){
+		png_image_free(&image);
+		return 0;
+	}
+	return create_texture(GL_RGBA8, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE, data.data(), GL_LINEAR);
+}
+
+// Curve flattening tolerance (angle)
+static constexpr double flatten_tolerance = 0.05;
+
+// Renderer private data
+struct InstanceData{
+	// Buffers (image channels stored in byte order of cairo's native endian ARGB, premultiplied; allocated for largest size yet, drawing on used area at area position in frame)
+	int x, y;
+	unsigned width, height,
+		buffer_width, buffer_height;
+	GLuint image_texture, image_fbo,
+		blur_texture, blur_fbo,
+		stencil_texture, stencil_fbo,
+		layer_texture, layer_fbo,	// Resolved layer
+		layer_color, layer_depth_stencil, layer_ms_fbo,	// Layer to draw path into (multisampled by antialiasing)
+		kernel_texture;
+	GLsizei layer_samples;
+	// Shaders & geometry
+	GLuint fill_program, composite_program, blur_program,
+		vertex_array, vertex_buffer;
+	std::unordered_map<std::string,GLuint> textures;	// By filename
+	// State
+	GUtils::Font font;
+	std::string deform_x, deform_y;
+	double deform_progress;
+	GUtils::Matrix4x4d matrix;
+	Backend::Renderer::Mode mode;
+	std::vector<std::array<double,4>> fill_color;	// RGBA, solid or 4 corners
+	std::array<double,4> line_color;	// RGBA
+	std::string texture_filename;
+	double texture_x, texture_y;
+	Backend::Renderer::TexWrap texture_wrap;
+	double line_width;
+	Backend::Renderer::LineJoin line_join;
+	Backend::Renderer::LineCap line_cap;
+	double dash_offset;
+	std::vector<double> dashes;
+	unsigned antialiasing;
+	Backend::Renderer::StencilMode stencil_mode;
+};
+#define INST_DATA reinterpret_cast<InstanceData*>(this->data)
+
+static void free_buffers(InstanceData* inst){
+	const GLuint textures[] = {inst->image_texture, inst->blur_texture, inst->stencil_texture, inst->layer_texture},
+		framebuffers[] = {inst->image_fbo, inst->blur_fbo, inst->stencil_fbo, inst->layer_fbo, inst->layer_ms_fbo},
+		renderbuffers[] = {inst->layer_color, inst->layer_depth_stencil};
+	glDeleteTextures(sizeof(textures) / sizeof(*textures), textures),
+	glDeleteFramebuffers(sizeof(framebuffers) / sizeof(*framebuffers), framebuffers),
+	glDeleteRenderbuffers(sizeof(renderbuffers) / sizeof(*renderbuffers), renderbuffers);
+	inst->image_texture = inst->blur_texture = inst->stencil_texture = inst->layer_texture = 0,
+	inst->image_fbo = inst->blur_fbo = inst->stencil_fbo = inst->layer_fbo = inst->layer_ms_fbo = 0,
+	inst->layer_color = inst->layer_depth_stencil = 0;
+}
+
+// (Re-)create drawing layer with samples for current antialiasing
+static void update_layer(InstanceData* inst){
+	GLsizei samples = 0;
+	if(inst->antialiasing){
+		GLint max_samples;
+		glGetIntegerv(GL_MAX_SAMPLES, &max_samples),
+		samples = std::min(static_cast<GLint>(inst->antialiasing), max_samples);
+	}
+	if(inst->layer_ms_fbo && samples == inst->layer_samples)
+		return;
+	glDeleteFramebuffers(1, &inst->layer_ms_fbo);
+	const GLuint renderbuffers[] = {inst->layer_color, inst->layer_depth_stencil};
+	glDeleteRenderbuffers(2, renderbuffers);
+	GLuint new_renderbuffers[2];
+	glGenRenderbuffers(2, new_renderbuffers),
+	glBindRenderbuffer(GL_RENDERBUFFER, new_renderbuffers[0]),
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, inst->buffer_width, inst->buffer_height),
+	glBindRenderbuffer(GL_RENDERBUFFER, new_renderbuffers[1]),
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, inst->buffer_width, inst->buffer_height),
+	glGenFramebuffers(1, &inst->layer_ms_fbo),
+	glBindFramebuffer(GL_FRAMEBUFFER, inst->layer_ms_fbo),
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, new_renderbuffers[0]),
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, new_renderbuffers[1]);
+	inst->layer_color = new_renderbuffers[0],
+	inst->layer_depth_stencil = new_renderbuffers[1],
+	inst->layer_samples = samples;
+}
+
+static void draw_vertices(InstanceData* inst, const std::vector<float>& vertices){
+	glBindVertexArray(inst->vertex_array),
+	glBindBuffer(GL_ARRAY_BUFFER, inst->vertex_buffer),
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW),
+	glDrawArrays(GL_TRIANGLES, 0, vertices.size() >> 1);
+}
+
+static std::vector<float> rectangle_vertices(float x0, float y0, float x1, float y1){
+	return {x0, y0, x1, y0, x1, y1, x0, y0, x1, y1, x0, y1};
+}
+
+static void use_program(InstanceData* inst, GLuint program){
+	glUseProgram(program),
+	glUniform2f(glGetUniformLocation(program, "size"), inst->width, inst->height);
+}
 
+// Draw flat path in frame space (nonzero rule) with color gradient over its extents & optional texture
+static void draw_path(InstanceData* inst, const std::vector<GUtils::PathSegment>& path, const std::array<double,4>* colors, bool textured){
+	// Fan triangles of contours (stencil counts winding) & extents
+	std::vector<float> vertices;
+	double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+	float start_x = 0, start_y = 0, last_x = 0, last_y = 0;	// Contour start & current point (close returns to start, like cairo)
+	bool open = false;
+	for(const GUtils::PathSegment& segment : path){
+		const float x = segment.x - inst->x, y = segment.y - inst->y;	// Frame to image area
+		switch(segment.type){
+			case GUtils::PathSegment::Type::MOVE:
+				start_x = last_x = x,
+				start_y = last_y = y,
+				open = true;
+				break;
+			case GUtils::PathSegment::Type::LINE:
+			case GUtils::PathSegment::Type::CURVE:
+				if(open)
+					vertices.insert(vertices.end(), {start_x, start_y, last_x, last_y, x, y});
+				else
+					start_x = x,
+					start_y = y,
+					open = true;
+				last_x = x,
+				last_y = y;
+				break;
+			case GUtils::PathSegment::Type::CLOSE:
+				last_x = start_x,
+				last_y = start_y;
+				break;
+		}
+		if(segment.type != GUtils::PathSegment::Type::CLOSE)
+			min_x = std::min(min_x, static_cast<double>(x)), min_y = std::min(min_y, static_cast<double>(y)),
+			max_x = std::max(max_x, static_cast<double>(x)), max_y = std::max(max_y, static_cast<double>(y));
+	}
+	// Limit work to image area covered by path
+	const GLint x0 = std::max(0.0, std::floor(min_x)), y0 = std::max(0.0, std::floor(min_y)),
+		x1 = std::min(static_cast<double>(inst->width), std::ceil(max_x)), y1 = std::min(static_cast<double>(inst->height), std::ceil(max_y));
+	if(vertices.empty() || x0 >= x1 || y0 >= y1)
+		return;
+	// Clear layer area
+	update_layer(inst),
+	glBindFramebuffer(GL_FRAMEBUFFER, inst->layer_ms_fbo),
+	glViewport(0, 0, inst->width, inst->height),
+	glEnable(GL_SCISSOR_TEST),
+	glScissor(x0, y0, x1 - x0, y1 - y0),
+	glClearColor(0, 0, 0, 0),
+	glClearStencil(0),
+	glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+	// Count winding in stencil
+	use_program(inst, inst->fill_program),
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE),
+	glEnable(GL_STENCIL_TEST),
+	glStencilFunc(GL_ALWAYS, 0, 0xff),
+	glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR_WRAP),
+	glStencilOpSeparate(GL_BACK, GL_KEEP, GL_KEEP, GL_DECR_WRAP),
+	draw_vertices(inst, vertices);
+	// Cover non-zero winding with fill
+	GLint colors_data_location = glGetUniformLocation(inst->fill_program, "colors");
+	const GLfloat colors_data[] = {
+		static_cast<GLfloat>(colors[0][0]), static_cast<GLfloat>(colors[0][1]), static_cast<GLfloat>(colors[0][2]), static_cast<GLfloat>(colors[0][3]),
+		static_cast<GLfloat>(colors[1][0]), static_cast<GLfloat>(colors[1][1]), static_cast<GLfloat>(colors[1][2]), static_cast<GLfloat>(colors[1][3]),
+		static_cast<GLfloat>(colors[2][0]), static_cast<GLfloat>(colors[2][1]), static_cast<GLfloat>(colors[2][2]), static_cast<GLfloat>(colors[2][3]),
+		static_cast<GLfloat>(colors[3][0]), static_cast<GLfloat>(colors[3][1]), static_cast<GLfloat>(colors[3][2]), static_cast<GLfloat>(colors[3][3])
+	};
+	glUniform4fv(colors_data_location, 4, colors_data),
+	glUniform4f(glGetUniformLocation(inst->fill_program, "box"), min_x, min_y, max_x, max_y);
+	GLuint texture = 0;
+	if(textured && !inst->texture_filename.empty()){
+		auto texture_iter = inst->textures.find(inst->texture_filename);
+		texture = texture_iter != inst->textures.end() ? texture_iter->second : (inst->textures[inst->texture_filename] = load_texture(inst->texture_filename));
 	}
+	glUniform1i(glGetUniformLocation(inst->fill_program, "textured"), texture != 0);
+	if(texture)
+		glActiveTexture(GL_TEXTURE0),
+		glBindTexture(GL_TEXTURE_2D, texture),
+		glUniform1i(glGetUniformLocation(inst->fill_program, "tex"), 0),
+		glUniform2f(glGetUniformLocation(inst->fill_program, "tex_offset"), inst->texture_x - inst->x, inst->texture_y - inst->y),
+		glUniform1i(glGetUniformLocation(inst->fill_program, "tex_wrap"), static_cast<GLint>(inst->texture_wrap));
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE),
+	glStencilFunc(GL_NOTEQUAL, 0, 0xff),
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP),
+	draw_vertices(inst, rectangle_vertices(x0, y0, x1, y1)),
+	glDisable(GL_STENCIL_TEST);
+	// Resolve layer samples
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, inst->layer_ms_fbo),
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, inst->layer_fbo),
+	glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	// Blend layer over image (through stencil) or coverage into stencil
+	const bool to_stencil = inst->stencil_mode == Backend::Renderer::StencilMode::SET || inst->stencil_mode == Backend::Renderer::StencilMode::UNSET;
+	glBindFramebuffer(GL_FRAMEBUFFER, to_stencil ? inst->stencil_fbo : inst->image_fbo),
+	use_program(inst, inst->composite_program),
+	glActiveTexture(GL_TEXTURE0),
+	glBindTexture(GL_TEXTURE_2D, inst->layer_texture),
+	glActiveTexture(GL_TEXTURE1),
+	glBindTexture(GL_TEXTURE_2D, to_stencil ? 0 : inst->stencil_texture),
+	glActiveTexture(GL_TEXTURE0),
+	glUniform1i(glGetUniformLocation(inst->composite_program, "layer"), 0),
+	glUniform1i(glGetUniformLocation(inst->composite_program, "stencil"), 1),
+	glUniform1i(glGetUniformLocation(inst->composite_program, "stencil_mode"), static_cast<GLint>(inst->stencil_mode)),
+	glEnable(GL_BLEND),
+	glBlendFunc(inst->stencil_mode == Backend::Renderer::StencilMode::UNSET ? GL_ZERO : GL_ONE, GL_ONE_MINUS_SRC_ALPHA),
+	draw_vertices(inst, rectangle_vertices(x0, y0, x1, y1)),
+	glDisable(GL_BLEND),
+	glDisable(GL_SCISSOR_TEST);
+}
+
+// Clear used area of buffer
+static void clear_buffer(InstanceData* inst, GLuint framebuffer){
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer),
+	glEnable(GL_SCISSOR_TEST),
+	glScissor(0, 0, inst->width, inst->height),
+	glClearColor(0, 0, 0, 0),
+	glClear(GL_COLOR_BUFFER_BIT),
+	glDisable(GL_SCISSOR_TEST);
+}
+
+// Path in frame space without curves
+static std::vector<GUtils::PathSegment> device_path(InstanceData* inst, const std::vector<GUtils::PathSegment>& path){
+	// Deform in path space (cached, flattened before so curves bend too)
+	std::vector<GUtils::PathSegment> result(inst->deform_x.empty() && inst->deform_y.empty() ? path :
+		*GUtils::path_deform_cached(path, flatten_tolerance, inst->deform_x, inst->deform_y, inst->deform_progress));
+	return GUtils::path_flatten(GUtils::path_transform(result, inst->matrix), flatten_tolerance);
+}
+
+// One direction of separable gaussian blur on image
+static void blur_pass(InstanceData* inst, float strength, GLint direction_x, GLint direction_y){
+	if(strength <= 0)
+		return;
+	const std::vector<float> kernel = GUtils::blur_kernel(strength);
+	glBindTexture(GL_TEXTURE_2D, inst->kernel_texture),
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, kernel.size(), 1, 0, GL_RED, GL_FLOAT, kernel.data());
+	// Image blurred into temporary buffer
+	glBindFramebuffer(GL_FRAMEBUFFER, inst->blur_fbo),
+	glViewport(0, 0, inst->width, inst->height),
+	use_program(inst, inst->blur_program),
+	glActiveTexture(GL_TEXTURE0),
+	glBindTexture(GL_TEXTURE_2D, inst->image_texture),
+	glActiveTexture(GL_TEXTURE1),
+	glBindTexture(GL_TEXTURE_2D, inst->kernel_texture),
+	glUniform1i(glGetUniformLocation(inst->blur_program, "source"), 0),
+	glUniform1i(glGetUniformLocation(inst->blur_program, "kernel"), 1),
+	glUniform2i(glGetUniformLocation(inst->blur_program, "direction"), direction_x, direction_y),
+	glUniform2i(glGetUniformLocation(inst->blur_program, "area"), inst->width, inst->height),
+	draw_vertices(inst, rectangle_vertices(0, 0, inst->width, inst->height)),
+	glActiveTexture(GL_TEXTURE0);
+	// Temporary buffer back to image
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, inst->blur_fbo),
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, inst->image_fbo),
+	glBlitFramebuffer(0, 0, inst->width, inst->height, 0, 0, inst->width, inst->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+namespace Backend{
+	Renderer::Renderer() : Renderer::Renderer(1, 1){}
 
-	Renderer::Renderer(unsigned width, unsigned height) : Renderer(){
+	Renderer::Renderer(unsigned width, unsigned height){
+		acquire_context();
+		// Create resources
+		InstanceData* inst = new InstanceData();
+		this->data = inst;
+		try{
+			char composite_source[1024];
+			const uint32_t byte_order = 0x01020304;
+			std::snprintf(composite_source, sizeof(composite_source), composite_shader_source, *reinterpret_cast<const unsigned char*>(&byte_order) == 0x04 ? "bgra" : "argb"),
+			inst->fill_program = create_program(fill_shader_source),
+			inst->composite_program = create_program(composite_source),
+			inst->blur_program = create_program(blur_shader_source);
+		}catch(...){
+			glDeleteProgram(inst->fill_program),
+			glDeleteProgram(inst->composite_program),
+			delete inst,
+			release_context();
+			throw;
+		}
+		glGenVertexArrays(1, &inst->vertex_array),
+		glGenBuffers(1, &inst->vertex_buffer),
+		glBindVertexArray(inst->vertex_array),
+		glBindBuffer(GL_ARRAY_BUFFER, inst->vertex_buffer),
+		glEnableVertexAttribArray(0),
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr),
+		inst->kernel_texture = create_texture(GL_R32F, 1, 1, GL_RED, GL_FLOAT, nullptr, GL_NEAREST),
+		glPixelStorei(GL_PACK_ALIGNMENT, 1),
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		this->reset(),
 		this->set_size(width, height);
 	}
 
 	void Renderer::set_size(unsigned width, unsigned height){
+		InstanceData* inst = INST_DATA;
+		// Grow buffers if needed (smaller sizes reuse them)
+		if(!inst->image_texture || width > inst->buffer_width || height > inst->buffer_height)
+			free_buffers(inst),
+			inst->buffer_width = std::max({width, inst->buffer_width, 1u}),
+			inst->buffer_height = std::max({height, inst->buffer_height, 1u}),
+			inst->image_texture = create_texture(GL_RGBA8, inst->buffer_width, inst->buffer_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr, GL_NEAREST),
+			inst->image_fbo = create_framebuffer(inst->image_texture),
+			inst->blur_texture = create_texture(GL_RGBA8, inst->buffer_width, inst->buffer_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr, GL_NEAREST),
+			inst->blur_fbo = create_framebuffer(inst->blur_texture),
+			inst->stencil_texture = create_texture(GL_R8, inst->buffer_width, inst->buffer_height, GL_RED, GL_UNSIGNED_BYTE, nullptr, GL_NEAREST),
+			inst->stencil_fbo = create_framebuffer(inst->stencil_texture),
+			inst->layer_texture = create_texture(GL_RGBA8, inst->buffer_width, inst->buffer_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr, GL_NEAREST),
+			inst->layer_fbo = create_framebuffer(inst->layer_texture),
+			update_layer(inst);
+		// Remove content of previous usage
+		inst->width = width,
+		inst->height = height,
+		this->clear_image(),
+		this->clear_stencil();
+	}
 
-		// TODO
-
+	void Renderer::set_area(int x, int y, unsigned width, unsigned height){
+		INST_DATA->x = x,
+		INST_DATA->y = y,
+		this->set_size(width, height);
 	}
 
 	Renderer::~Renderer(){
+		// Delete resources
+		InstanceData* inst = INST_DATA;
+		free_buffers(inst),
+		glDeleteTextures(1, &inst->kernel_texture);
+		for(auto& texture : inst->textures)
+			glDeleteTextures(1, &texture.second);
+		glDeleteProgram(inst->fill_program),
+		glDeleteProgram(inst->composite_program),
+		glDeleteProgram(inst->blur_program),
+		glDeleteBuffers(1, &inst->vertex_buffer),
+		glDeleteVertexArrays(1, &inst->vertex_array),
+		delete inst;
 		// Update contexts for one deletion
-		{
-			std::unique_lock<std::mutex> lock(contexts_mutex);
-			auto thread_id = std::this_thread::get_id();
-			if(--contexts[thread_id].ref_count == 0){
-				// Destroy context
-				contexts.erase(thread_id);
-				// Terminate GLFW on non-remaining context
-				if(contexts.empty())
-					glfwTerminate();
-			}
+		release_context();
+	}
+
+	unsigned Renderer::width(){
+		return INST_DATA->width;
+	}
+
+	unsigned Renderer::height(){
+		return INST_DATA->height;
+	}
+
+	int Renderer::x(){
+		return INST_DATA->x;
+	}
+
+	int Renderer::y(){
+		return INST_DATA->y;
+	}
+
+	void Renderer::copy_image(unsigned char* image, unsigned padding){
+		const unsigned rowsize = INST_DATA->width << 2;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, INST_DATA->image_fbo);
+		// Read rows directly into destination or over buffer for padding
+		if(!padding)
+			glReadPixels(0, 0, INST_DATA->width, INST_DATA->height, GL_RGBA, GL_UNSIGNED_BYTE, image);
+		else{
+			std::vector<unsigned char> buffer(INST_DATA->height * rowsize);
+			glReadPixels(0, 0, INST_DATA->width, INST_DATA->height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.data());
+			for(const unsigned char* src_data = buffer.data(), * const src_data_end = src_data + buffer.size(); src_data != src_data_end; src_data += rowsize)
+				image = std::copy(src_data, src_data+rowsize, image) + padding;
 		}
+	}
 
-		// TODO: delete resources
+	void Renderer::reset(){
+		INST_DATA->font = GUtils::Font("Arial"),
+		INST_DATA->deform_x.clear(),
+		INST_DATA->deform_y.clear(),
+		INST_DATA->deform_progress = 0,
+		INST_DATA->matrix.identity(),
+		INST_DATA->mode = Renderer::Mode::FILL,
+		INST_DATA->fill_color = {{1, 1, 1, 1}},
+		INST_DATA->line_color = {0, 0, 0, 1},
+		INST_DATA->texture_filename.clear(),
+		INST_DATA->texture_x = INST_DATA->texture_y = 0,
+		INST_DATA->texture_wrap = Renderer::TexWrap::CLAMP,
+		INST_DATA->line_width = 4,	// Line width = 2x border width
+		INST_DATA->line_join = Renderer::LineJoin::ROUND,
+		INST_DATA->line_cap = Renderer::LineCap::ROUND,
+		INST_DATA->dash_offset = 0,
+		INST_DATA->dashes.clear(),
+		INST_DATA->antialiasing = 8,
+		INST_DATA->stencil_mode = Renderer::StencilMode::OFF;
+	}
 
+	void Renderer::set_font(const std::string& family, float size, bool bold, bool italic, bool underline, bool strikeout, double spacing){
+		INST_DATA->font = GUtils::Font(family, size, bold, italic, underline, strikeout, spacing);
 	}
 
-	unsigned Renderer::width(){
+	void Renderer::set_deform(const std::string& x_formula, const std::string& y_formula, double progress){
+		INST_DATA->deform_x = x_formula,
+		INST_DATA->deform_y = y_formula,
+		INST_DATA->deform_progress = progress;
+	}
 
-		// TODO
+	void Renderer::set_matrix(const GUtils::Matrix4x4d& matrix){
+		INST_DATA->matrix = matrix;
+	}
 
-		return 0;
+	void Renderer::set_mode(Renderer::Mode mode){
+		INST_DATA->mode = mode;
 	}
 
-	unsigned Renderer::height(){
+	void Renderer::set_fill_color(double r, double g, double b, double a){
+		INST_DATA->fill_color = {{r, g, b, a}};
+	}
 
-		// TODO
+	void Renderer::set_fill_color(double r0, double g0, double b0, double a0,
+			double r1, double g1, double b1, double a1,
+			double r2, double g2, double b2, double a2,
+			double r3, double g3, double b3, double a3){
+		INST_DATA->fill_color = {{r0, g0, b0, a0}, {r1, g1, b1, a1}, {r2, g2, b2, a2}, {r3, g3, b3, a3}};
+	}
 
-		return 0;
+	void Renderer::set_line_color(double r, double g, double b, double a){
+		INST_DATA->line_color = {r, g, b, a};
 	}
 
-	void Renderer::copy_image(unsigned char* image, unsigned padding){
+	void Renderer::set_texture(const std::string& filename){
+		INST_DATA->texture_filename = filename;
+	}
+
+	void Renderer::set_texture_offset(double x, double y){
+		INST_DATA->texture_x = x,
+		INST_DATA->texture_y = y;
+	}
+
+	void Renderer::set_texture_wrap(Renderer::TexWrap wrap){
+		INST_DATA->texture_wrap = wrap;
+	}
+
+	void Renderer::set_line_width(double width){
+		INST_DATA->line_width = width;
+	}
+
+	void Renderer::set_line_join(Renderer::LineJoin join){
+		INST_DATA->line_join = join;
+	}
+
+	void Renderer::set_line_cap(Renderer::LineCap cap){
+		INST_DATA->line_cap = cap;
+	}
+
+	void Renderer::set_line_dash(double offset, const std::vector<double>& dashes){
+		INST_DATA->dash_offset = offset,
+		INST_DATA->dashes = dashes;
+	}
+
+	void Renderer::set_antialiasing(unsigned level){
+		INST_DATA->antialiasing = level ? 8 : 0;
+	}
 
-		// TODO
+	void Renderer::set_stencil_mode(Renderer::StencilMode mode){
+		INST_DATA->stencil_mode = mode;
+	}
+
+	std::string Renderer::get_font_family(){
+		return INST_DATA->font.get_family();
+	}
+
+	float Renderer::get_font_size(){
+		return INST_DATA->font.get_size();
+	}
 
+	bool Renderer::get_font_bold(){
+		return INST_DATA->font.get_bold();
+	}
+
+	bool Renderer::get_font_italic(){
+		return INST_DATA->font.get_italic();
+	}
+
+	bool Renderer::get_font_underline(){
+		return INST_DATA->font.get_underline();
+	}
+
+	bool Renderer::get_font_strikeout(){
+		return INST_DATA->font.get_strikeout();
+	}
+
+	double Renderer::get_font_spacing(){
+		return INST_DATA->font.get_spacing();
+	}
+
+	std::string Renderer::get_deform_x(){
+		return INST_DATA->deform_x;
+	}
+
+	std::string Renderer::get_deform_y(){
+		return INST_DATA->deform_y;
+	}
+
+	double Renderer::get_deform_progress(){
+		return INST_DATA->deform_progress;
+	}
+
+	GUtils::Matrix4x4d Renderer::get_matrix(){
+		return INST_DATA->matrix;
+	}
+
+	Renderer::Mode Renderer::get_mode(){
+		return INST_DATA->mode;
+	}
+
+	std::vector<std::array<double,4>> Renderer::get_fill_color(){
+		return INST_DATA->fill_color;
+	}
+
+	std::array<double,4> Renderer::get_line_color(){
+		return INST_DATA->line_color;
+	}
+
+	std::string Renderer::get_texture(){
+		return INST_DATA->texture_filename;
+	}
+
+	double Renderer::get_texture_offset_x(){
+		return INST_DATA->texture_x;
+	}
+
+	double Renderer::get_texture_offset_y(){
+		return INST_DATA->texture_y;
+	}
+
+	Renderer::TexWrap Renderer::get_texture_wrap(){
+		return INST_DATA->texture_wrap;
+	}
+
+	double Renderer::get_line_width(){
+		return INST_DATA->line_width;
+	}
+
+	Renderer::LineJoin Renderer::get_line_join(){
+		return INST_DATA->line_join;
+	}
+
+	Renderer::LineCap Renderer::get_line_cap(){
+		return INST_DATA->line_cap;
+	}
+
+	double Renderer::get_line_dash_offset(){
+		return INST_DATA->dash_offset;
+	}
+
+	std::vector<double> Renderer::get_line_dash(){
+		return INST_DATA->dashes;
+	}
+
+	unsigned Renderer::get_antialiasing(){
+		return INST_DATA->antialiasing;
+	}
+
+	Renderer::StencilMode Renderer::get_stencil_mode(){
+		return INST_DATA->stencil_mode;
+	}
+
+	GUtils::Font::Metrics Renderer::font_metrics(){
+		return INST_DATA->font.metrics();
+	}
+
+	double Renderer::text_width(const std::string& text){
+		return INST_DATA->font.text_width(text);
+	}
+	std::vector<GUtils::PathSegment> Renderer::text_path(const std::string& text){
+		return INST_DATA->font.text_path(text);
+	}
+
+	void Renderer::clear_image(){
+		clear_buffer(INST_DATA, INST_DATA->image_fbo);
 	}
 
 	void Renderer::clear_stencil(){
+		clear_buffer(INST_DATA, INST_DATA->stencil_fbo);
+	}
 
-		// TODO
+	void Renderer::fill_path(const std::vector<GUtils::PathSegment>& path){
+		const std::vector<std::array<double,4>>& colors = INST_DATA->fill_color;
+		const std::array<double,4> corner_colors[] = {colors[0], colors[colors.size() > 1 ? 1 : 0], colors[colors.size() > 2 ? 2 : 0], colors[colors.size() > 3 ? 3 : 0]};
+		draw_path(INST_DATA, device_path(INST_DATA, path), corner_colors, true);
+	}
+
+	void Renderer::stroke_path(const std::vector<GUtils::PathSegment>& path){
+		GUtils::LineJoin join = GUtils::LineJoin::ROUND;
+		switch(INST_DATA->line_join){
+			case Renderer::LineJoin::ROUND: join = GUtils::LineJoin::ROUND; break;
+			case Renderer::LineJoin::BEVEL: join = GUtils::LineJoin::BEVEL; break;
+			case Renderer::LineJoin::MITER: join = GUtils::LineJoin::MITER; break;
+		}
+		GUtils::LineCap cap = GUtils::LineCap::ROUND;
+		switch(INST_DATA->line_cap){
+			case Renderer::LineCap::ROUND: cap = GUtils::LineCap::ROUND; break;
+			case Renderer::LineCap::SQUARE: cap = GUtils::LineCap::SQUARE; break;
+			case Renderer::LineCap::FLAT: cap = GUtils::LineCap::FLAT; break;
+		}
+		const std::array<double,4> colors[] = {INST_DATA->line_color, INST_DATA->line_color, INST_DATA->line_color, INST_DATA->line_color};
+		draw_path(
+			INST_DATA,
+			*GUtils::path_stroke_cached(device_path(INST_DATA, path), INST_DATA->line_width, join, cap, INST_DATA->dash_offset, INST_DATA->dashes),
+			colors, false
+		);
+	}
 
+	void Renderer::blur_image(float strength_h, float strength_v){
+		blur_pass(INST_DATA, strength_h, 1, 0),
+		blur_pass(INST_DATA, strength_v, 0, 1);
 	}
 }
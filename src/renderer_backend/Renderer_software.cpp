@@ -0,0 +1,399 @@
+/*
+Project: SSBRenderer
+File: Renderer_software.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Renderer.hpp"
+#include <cstdint>
+#include <cmath>
+
+// Curve flattening tolerance (angle)
+static constexpr double flatten_tolerance = 0.05;
+
+// Renderer private data
+struct InstanceData{
+	// Buffers (image pixels premultiplied ARGB in native endian, like cairo; area position in frame)
+	int x, y;
+	unsigned width, height;
+	std::vector<uint32_t> image;
+	GUtils::SpanMask stencil;	// Touched area only
+	// State
+	GUtils::Font font;
+	std::string deform_x, deform_y;
+	double deform_progress;
+	GUtils::Matrix4x4d matrix;
+	Backend::Renderer::Mode mode;
+	std::vector<std::array<double,4>> fill_color;	// RGBA, solid or 4 corners
+	std::array<double,4> line_color;	// RGBA
+	std::string texture_filename;
+	double texture_x, texture_y;
+	Backend::Renderer::TexWrap texture_wrap;
+	double line_width;
+	Backend::Renderer::LineJoin line_join;
+	Backend::Renderer::LineCap line_cap;
+	double dash_offset;
+	std::vector<double> dashes;
+	unsigned antialiasing;
+	Backend::Renderer::StencilMode stencil_mode;
+};
+#define INST_DATA reinterpret_cast<InstanceData*>(this->data)
+
+// Blend coverage mask at position with color over image
+static void draw_mask(InstanceData* inst, const GUtils::Image2D<>& mask, int mask_x, int mask_y, const std::array<double,4>& color){
+	// Clip mask to image
+	const int x0 = std::max(mask_x, 0),
+		y0 = std::max(mask_y, 0),
+		x1 = std::min(mask_x + static_cast<int>(mask.get_width()), static_cast<int>(inst->width)),
+		y1 = std::min(mask_y + static_cast<int>(mask.get_height()), static_cast<int>(inst->height));
+	if(x0 >= x1 || y0 >= y1)
+		return;
+	// Color to 8-bit
+	auto to_byte = [](double value){
+		return static_cast<unsigned>(std::max(0.0, std::min(1.0, value)) * 255 + 0.5);
+	};
+	const unsigned r = to_byte(color[0]), g = to_byte(color[1]), b = to_byte(color[2]), alpha = to_byte(color[3]);
+	if(!alpha)
+		return;
+	// Source over destination (premultiplied)
+	for(int y = y0; y < y1; ++y){
+		const unsigned char* mask_row = mask.get_data() + (y - mask_y) * mask.get_stride() - mask_x;
+		uint32_t* image_row = inst->image.data() + y * inst->width;
+		for(int x = x0; x < x1; ++x){
+			const unsigned a = (alpha * mask_row[x] + 127) / 255;
+			if(!a)
+				continue;
+			const unsigned inv_a = 255 - a;
+			const uint32_t dst = image_row[x];
+			image_row[x] = ((a + ((dst >> 24) * inv_a + 127) / 255) << 24) |
+				(((r * a + 127) / 255 + (((dst >> 16) & 0xff) * inv_a + 127) / 255) << 16) |
+				(((g * a + 127) / 255 + (((dst >> 8) & 0xff) * inv_a + 127) / 255) << 8) |
+				((b * a + 127) / 255 + ((dst & 0xff) * inv_a + 127) / 255);
+		}
+	}
+}
+
+// Apply coverage mask by stencil mode (into stencil or over image)
+static void apply_mask(InstanceData* inst, GUtils::Image2D<>& mask, int mask_x, int mask_y, const std::array<double,4>& color){
+	if(!inst->antialiasing)
+		for(unsigned char* pmask = mask.get_data(), * const pmask_end = pmask + mask.get_size(); pmask != pmask_end; ++pmask)
+			*pmask = *pmask < 128 ? 0 : 255;
+	switch(inst->stencil_mode){
+		case Backend::Renderer::StencilMode::OFF: draw_mask(inst, mask, mask_x, mask_y, color); break;
+		case Backend::Renderer::StencilMode::SET: inst->stencil.unite(mask, mask_x, mask_y); break;
+		case Backend::Renderer::StencilMode::UNSET: inst->stencil.subtract(mask, mask_x, mask_y); break;
+		case Backend::Renderer::StencilMode::INSIDE:
+		case Backend::Renderer::StencilMode::OUTSIDE:
+			inst->stencil.clip(mask, mask_x, mask_y, inst->stencil_mode == Backend::Renderer::StencilMode::INSIDE),
+			draw_mask(inst, mask, mask_x, mask_y, color);
+			break;
+	}
+}
+
+// Path in frame space without curves
+static std::vector<GUtils::PathSegment> device_path(InstanceData* inst, const std::vector<GUtils::PathSegment>& path){
+	// Deform in path space (cached, flattened before so curves bend too)
+	std::vector<GUtils::PathSegment> result(inst->deform_x.empty() && inst->deform_y.empty() ? path :
+		*GUtils::path_deform_cached(path, flatten_tolerance, inst->deform_x, inst->deform_y, inst->deform_progress));
+	return GUtils::path_flatten(GUtils::path_transform(result, inst->matrix), flatten_tolerance);
+}
+
+namespace Backend{
+	Renderer::Renderer() : Renderer::Renderer(1, 1){}
+
+	Renderer::Renderer(unsigned width, unsigned height){
+		this->data = new InstanceData(),
+		this->set_size(width, height),
+		this->reset();
+	}
+
+	void Renderer::set_size(unsigned width, unsigned height){
+		INST_DATA->width = width,
+		INST_DATA->height = height,
+		INST_DATA->image.assign(width * height, 0),
+		INST_DATA->stencil.clear();
+	}
+
+	void Renderer::set_area(int x, int y, unsigned width, unsigned height){
+		INST_DATA->x = x,
+		INST_DATA->y = y,
+		this->set_size(width, height);
+	}
+
+	Renderer::~Renderer(){
+		delete INST_DATA;
+	}
+
+	unsigned Renderer::width(){
+		return INST_DATA->width;
+	}
+
+	unsigned Renderer::height(){
+		return INST_DATA->height;
+	}
+
+	int Renderer::x(){
+		return INST_DATA->x;
+	}
+
+	int Renderer::y(){
+		return INST_DATA->y;
+	}
+
+	void Renderer::copy_image(unsigned char* image, unsigned padding){
+		const unsigned rowsize = INST_DATA->width << 2;
+		const unsigned char* src_data = reinterpret_cast<const unsigned char*>(INST_DATA->image.data());
+		for(const unsigned char* const src_data_end = src_data + INST_DATA->height * rowsize; src_data != src_data_end; src_data += rowsize)
+			image = std::copy(src_data, src_data+rowsize, image) + padding;
+	}
+
+	void Renderer::reset(){
+		INST_DATA->font = GUtils::Font("Arial"),
+		INST_DATA->deform_x.clear(),
+		INST_DATA->deform_y.clear(),
+		INST_DATA->deform_progress = 0,
+		INST_DATA->matrix.identity(),
+		INST_DATA->mode = Renderer::Mode::FILL,
+		INST_DATA->fill_color = {{1, 1, 1, 1}},
+		INST_DATA->line_color = {0, 0, 0, 1},
+		INST_DATA->texture_filename.clear(),
+		INST_DATA->texture_x = INST_DATA->texture_y = 0,
+		INST_DATA->texture_wrap = Renderer::TexWrap::CLAMP,
+		INST_DATA->line_width = 4,	// Line width = 2x border width
+		INST_DATA->line_join = Renderer::LineJoin::ROUND,
+		INST_DATA->line_cap = Renderer::LineCap::ROUND,
+		INST_DATA->dash_offset = 0,
+		INST_DATA->dashes.clear(),
+		INST_DATA->antialiasing = 8,
+		INST_DATA->stencil_mode = Renderer::StencilMode::OFF;
+	}
+
+	void Renderer::set_font(const std::string& family, float size, bool bold, bool italic, bool underline, bool strikeout, double spacing){
+		INST_DATA->font = GUtils::Font(family, size, bold, italic, underline, strikeout, spacing);
+	}
+
+	void Renderer::set_deform(const std::string& x_formula, const std::string& y_formula, double progress){
+		INST_DATA->deform_x = x_formula,
+		INST_DATA->deform_y = y_formula,
+		INST_DATA->deform_progress = progress;
+	}
+
+	void Renderer::set_matrix(const GUtils::Matrix4x4d& matrix){
+		INST_DATA->matrix = matrix;
+	}
+
+	void Renderer::set_mode(Renderer::Mode mode){
+		INST_DATA->mode = mode;
+	}
+
+	void Renderer::set_fill_color(double r, double g, double b, double a){
+		INST_DATA->fill_color = {{r, g, b, a}};
+	}
+
+	void Renderer::set_fill_color(double r0, double g0, double b0, double a0,
+			double r1, double g1, double b1, double a1,
+			double r2, double g2, double b2, double a2,
+			double r3, double g3, double b3, double a3){
+		INST_DATA->fill_color = {{r0, g0, b0, a0}, {r1, g1, b1, a1}, {r2, g2, b2, a2}, {r3, g3, b3, a3}};
+	}
+
+	void Renderer::set_line_color(double r, double g, double b, double a){
+		INST_DATA->line_color = {r, g, b, a};
+	}
+
+	void Renderer::set_texture(const std::string& filename){
+		INST_DATA->texture_filename = filename;
+	}
+
+	void Renderer::set_texture_offset(double x, double y){
+		INST_DATA->texture_x = x,
+		INST_DATA->texture_y = y;
+	}
+
+	void Renderer::set_texture_wrap(Renderer::TexWrap wrap){
+		INST_DATA->texture_wrap = wrap;
+	}
+
+	void Renderer::set_line_width(double width){
+		INST_DATA->line_width = width;
+	}
+
+	void Renderer::set_line_join(Renderer::LineJoin join){
+		INST_DATA->line_join = join;
+	}
+
+	void Renderer::set_line_cap(Renderer::LineCap cap){
+		INST_DATA->line_cap = cap;
+	}
+
+	void Renderer::set_line_dash(double offset, const std::vector<double>& dashes){
+		INST_DATA->dash_offset = offset,
+		INST_DATA->dashes = dashes;
+	}
+
+	void Renderer::set_antialiasing(unsigned level){
+		INST_DATA->antialiasing = level ? 8 : 0;
+	}
+
+	void Renderer::set_stencil_mode(Renderer::StencilMode mode){
+		INST_DATA->stencil_mode = mode;
+	}
+
+	std::string Renderer::get_font_family(){
+		return INST_DATA->font.get_family();
+	}
+
+	float Renderer::get_font_size(){
+		return INST_DATA->font.get_size();
+	}
+
+	bool Renderer::get_font_bold(){
+		return INST_DATA->font.get_bold();
+	}
+
+	bool Renderer::get_font_italic(){
+		return INST_DATA->font.get_italic();
+	}
+
+	bool Renderer::get_font_underline(){
+		return INST_DATA->font.get_underline();
+	}
+
+	bool Renderer::get_font_strikeout(){
+		return INST_DATA->font.get_strikeout();
+	}
+
+	double Renderer::get_font_spacing(){
+		return INST_DATA->font.get_spacing();
+	}
+
+	std::string Renderer::get_deform_x(){
+		return INST_DATA->deform_x;
+	}
+
+	std::string Renderer::get_deform_y(){
+		return INST_DATA->deform_y;
+	}
+
+	double Renderer::get_deform_progress(){
+		return INST_DATA->deform_progress;
+	}
+
+	GUtils::Matrix4x4d Renderer::get_matrix(){
+		return INST_DATA->matrix;
+	}
+
+	Renderer::Mode Renderer::get_mode(){
+		return INST_DATA->mode;
+	}
+
+	std::vector<std::array<double,4>> Renderer::get_fill_color(){
+		return INST_DATA->fill_color;
+	}
+
+	std::array<double,4> Renderer::get_line_color(){
+		return INST_DATA->line_color;
+	}
+
+	std::string Renderer::get_texture(){
+		return INST_DATA->texture_filename;
+	}
+
+	double Renderer::get_texture_offset_x(){
+		return INST_DATA->texture_x;
+	}
+
+	double Renderer::get_texture_offset_y(){
+		return INST_DATA->texture_y;
+	}
+
+	Renderer::TexWrap Renderer::get_texture_wrap(){
+		return INST_DATA->texture_wrap;
+	}
+
+	double Renderer::get_line_width(){
+		return INST_DATA->line_width;
+	}
+
+	Renderer::LineJoin Renderer::get_line_join(){
+		return INST_DATA->line_join;
+	}
+
+	Renderer::LineCap Renderer::get_line_cap(){
+		return INST_DATA->line_cap;
+	}
+
+	double Renderer::get_line_dash_offset(){
+		return INST_DATA->dash_offset;
+	}
+
+	std::vector<double> Renderer::get_line_dash(){
+		return INST_DATA->dashes;
+	}
+
+	unsigned Renderer::get_antialiasing(){
+		return INST_DATA->antialiasing;
+	}
+
+	Renderer::StencilMode Renderer::get_stencil_mode(){
+		return INST_DATA->stencil_mode;
+	}
+
+	GUtils::Font::Metrics Renderer::font_metrics(){
+		return INST_DATA->font.metrics();
+	}
+
+	double Renderer::text_width(const std::string& text){
+		return INST_DATA->font.text_width(text);
+	}
+	std::vector<GUtils::PathSegment> Renderer::text_path(const std::string& text){
+		return INST_DATA->font.text_path(text);
+	}
+
+	void Renderer::clear_image(){
+		std::fill(INST_DATA->image.begin(), INST_DATA->image.end(), 0);
+	}
+
+	void Renderer::clear_stencil(){
+		INST_DATA->stencil.clear();
+	}
+
+	void Renderer::fill_path(const std::vector<GUtils::PathSegment>& path){
+		int mask_x, mask_y;
+		GUtils::Image2D<> mask = GUtils::path_rasterize(device_path(INST_DATA, path), GUtils::FillRule::NONZERO, INST_DATA->x, INST_DATA->y, INST_DATA->width, INST_DATA->height, mask_x, mask_y);
+		apply_mask(INST_DATA, mask, mask_x - INST_DATA->x, mask_y - INST_DATA->y, INST_DATA->fill_color.front());
+	}
+
+	void Renderer::stroke_path(const std::vector<GUtils::PathSegment>& path){
+		GUtils::LineJoin join = GUtils::LineJoin::ROUND;
+		switch(INST_DATA->line_join){
+			case Renderer::LineJoin::ROUND: join = GUtils::LineJoin::ROUND; break;
+			case Renderer::LineJoin::BEVEL: join = GUtils::LineJoin::BEVEL; break;
+			case Renderer::LineJoin::MITER: join = GUtils::LineJoin::MITER; break;
+		}
+		GUtils::LineCap cap = GUtils::LineCap::ROUND;
+		switch(INST_DATA->line_cap){
+			case Renderer::LineCap::ROUND: cap = GUtils::LineCap::ROUND; break;
+			case Renderer::LineCap::SQUARE: cap = GUtils::LineCap::SQUARE; break;
+			case Renderer::LineCap::FLAT: cap = GUtils::LineCap::FLAT; break;
+		}
+		int mask_x, mask_y;
+		GUtils::Image2D<> mask = GUtils::path_rasterize(
+			*GUtils::path_stroke_cached(device_path(INST_DATA, path), INST_DATA->line_width, join, cap, INST_DATA->dash_offset, INST_DATA->dashes),
+			GUtils::FillRule::NONZERO, INST_DATA->x, INST_DATA->y, INST_DATA->width, INST_DATA->height, mask_x, mask_y
+		);
+		apply_mask(INST_DATA, mask, mask_x - INST_DATA->x, mask_y - INST_DATA->y, INST_DATA->line_color);
+	}
+
+	void Renderer::blur_image(float strength_h, float strength_v){
+		GUtils::blur(reinterpret_cast<unsigned char*>(INST_DATA->image.data()), INST_DATA->width, INST_DATA->height, INST_DATA->width << 2, GUtils::ColorDepth::X4, strength_h, strength_v);
+	}
+}
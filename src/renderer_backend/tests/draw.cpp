@@ -0,0 +1,163 @@
+/*
+Project: SSBRenderer
+File: draw.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../Renderer.hpp"
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+// Pixel of copied image (native endian ARGB)
+static uint32_t pixel(const std::vector<unsigned char>& image, unsigned stride, unsigned x, unsigned y){
+	uint32_t value;
+	std::memcpy(&value, image.data() + y * stride + (x << 2), sizeof(value));
+	return value;
+}
+
+// Rectangle path
+static std::vector<GUtils::PathSegment> rectangle(double x0, double y0, double x1, double y1){
+	return {
+		{GUtils::PathSegment::Type::MOVE, x0, y0},
+		{GUtils::PathSegment::Type::LINE, x1, y0},
+		{GUtils::PathSegment::Type::LINE, x1, y1},
+		{GUtils::PathSegment::Type::LINE, x0, y1},
+		{GUtils::PathSegment::Type::CLOSE, x0, y0}
+	};
+}
+
+int main(){
+	// Backend output has to match for every implementation
+	Backend::Renderer renderer(40, 30);
+	// Pixel-aligned rectangle, translated by matrix
+	renderer.set_fill_color(1, 0, 0, 1);
+	GUtils::Matrix4x4d matrix;
+	renderer.set_matrix(matrix.translate(5, 5, 0));
+	renderer.fill_path(rectangle(0, 0, 10, 10));
+	// Horizontal stroke with flat caps, half transparent
+	renderer.set_matrix(matrix.identity());
+	renderer.set_line_color(0, 0, 1, 0.5);
+	renderer.set_line_width(4);
+	renderer.set_line_cap(Backend::Renderer::LineCap::FLAT);
+	renderer.stroke_path({
+		{GUtils::PathSegment::Type::MOVE, 20, 20},
+		{GUtils::PathSegment::Type::LINE, 30, 20}
+	});
+	// State setters without drawing
+	const std::vector<double> dashes{2, 3};
+	renderer.set_line_dash(1, dashes);
+	renderer.set_line_dash(1, dashes);
+	if(renderer.get_line_dash() != dashes || renderer.get_line_dash_offset() != 1 || renderer.get_line_cap() != Backend::Renderer::LineCap::FLAT)
+		throw std::logic_error("Line state lost");
+	renderer.set_line_dash(0, {});
+	// Copy image with row padding
+	const unsigned padding = 8, stride = (renderer.width() << 2) + padding;
+	std::vector<unsigned char> image(stride * renderer.height(), 0xCD);
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 10, 10) != 0xffff0000 || pixel(image, stride, 5, 5) != 0xffff0000 || pixel(image, stride, 14, 14) != 0xffff0000)
+		throw std::logic_error("Filled rectangle not opaque red");
+	if(pixel(image, stride, 4, 10) || pixel(image, stride, 15, 10) || pixel(image, stride, 10, 15))
+		throw std::logic_error("Filled rectangle too large");
+	const uint32_t line_pixel = pixel(image, stride, 25, 19);
+	if(line_pixel >> 24 < 126 || line_pixel >> 24 > 129 || (line_pixel & 0xff) != line_pixel >> 24 || line_pixel & 0x00ffff00)
+		throw std::logic_error("Stroke not half transparent blue");
+	if(pixel(image, stride, 25, 17) || pixel(image, stride, 25, 22) || pixel(image, stride, 18, 20) || pixel(image, stride, 31, 20))
+		throw std::logic_error("Stroke too large");
+	if(image[(renderer.width() << 2)] != 0xCD)
+		throw std::logic_error("Image padding overwritten");
+	// Blur softens rectangle edges
+	renderer.blur_image(2, 2);
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 10, 10) >> 24 < 250 || !(pixel(image, stride, 4, 10) >> 24) || pixel(image, stride, 4, 10) >> 24 > 128)
+		throw std::logic_error("Blur not applied");
+	// Clear image
+	renderer.clear_image();
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 10, 10))
+		throw std::logic_error("Image not cleared");
+	// Stencil restricts drawing (set & unset area, fill inside, then outside)
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::SET);
+	renderer.fill_path(rectangle(0, 0, 20, 30));
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::UNSET);
+	renderer.fill_path(rectangle(0, 0, 5, 30));
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::INSIDE);
+	renderer.fill_path(rectangle(0, 0, 40, 30));
+	renderer.set_fill_color(0, 0, 1, 1);
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::OUTSIDE);
+	renderer.fill_path(rectangle(0, 0, 40, 30));
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 2, 10) != 0xff0000ff || pixel(image, stride, 5, 10) != 0xffff0000 || pixel(image, stride, 19, 29) != 0xffff0000 || pixel(image, stride, 20, 0) != 0xff0000ff)
+		throw std::logic_error("Stencil not respected");
+	renderer.clear_stencil();
+	renderer.set_fill_color(0, 1, 0, 1);
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::INSIDE);
+	renderer.fill_path(rectangle(0, 0, 40, 30));
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 10, 10) != 0xffff0000 || renderer.get_stencil_mode() != Backend::Renderer::StencilMode::INSIDE)
+		throw std::logic_error("Stencil not cleared");
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::OFF);
+	renderer.clear_image();
+	// Contour continued after close starts at contour start (close point without coordinates)
+	renderer.fill_path({
+		{GUtils::PathSegment::Type::MOVE, 30, 30},
+		{GUtils::PathSegment::Type::LINE, 20, 30},
+		{GUtils::PathSegment::Type::LINE, 20, 20},
+		{GUtils::PathSegment::Type::LINE, 30, 20},
+		{GUtils::PathSegment::Type::CLOSE, 0, 0},
+		{GUtils::PathSegment::Type::LINE, 22, 28},
+		{GUtils::PathSegment::Type::LINE, 28, 22}
+	});
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 22, 25) != 0xff00ff00 || pixel(image, stride, 26, 26) != 0xff00ff00 || pixel(image, stride, 10, 10))
+		throw std::logic_error("Contour after close not filled from contour start");
+	renderer.clear_image();
+	// Deform moves path points by formulas with progress (twice for cached result)
+	renderer.set_deform("x + t*20", "", 0.5);
+	renderer.fill_path(rectangle(0, 0, 5, 5));
+	renderer.fill_path(rectangle(0, 20, 5, 25));
+	renderer.set_deform("", "", 0);
+	renderer.copy_image(image.data(), padding);
+	if(pixel(image, stride, 12, 2) != 0xff00ff00 || pixel(image, stride, 12, 22) != 0xff00ff00 || pixel(image, stride, 2, 2) || pixel(image, stride, 2, 22))
+		throw std::logic_error("Deformed path not moved");
+	renderer.clear_image();
+	// Smaller size reuses buffers with empty content & keeps state
+	renderer.set_fill_color(0, 1, 0, 1);
+	renderer.fill_path(rectangle(0, 0, 40, 30));
+	renderer.set_size(8, 6);
+	std::vector<unsigned char> small_image(8 * 6 * 4, 0xCD);
+	renderer.copy_image(small_image.data(), 0);
+	if(renderer.width() != 8 || renderer.height() != 6 || std::count(small_image.begin(), small_image.end(), 0) != static_cast<long>(small_image.size()))
+		throw std::logic_error("Resized image not empty");
+	renderer.fill_path(rectangle(0, 0, 40, 30));
+	renderer.copy_image(small_image.data(), 0);
+	if(pixel(small_image, 8 << 2, 0, 0) != 0xff00ff00 || pixel(small_image, 8 << 2, 7, 5) != 0xff00ff00 || renderer.get_line_width() != 4)
+		throw std::logic_error("Resized image not drawn");
+	// Image as frame area draws frame coordinates relative to area position, outside clipped
+	renderer.set_area(100, 50, 8, 6);
+	renderer.fill_path(rectangle(102, 52, 120, 60));
+	renderer.set_line_color(0, 0, 1, 1);
+	renderer.set_line_width(2);
+	renderer.stroke_path({
+		{GUtils::PathSegment::Type::MOVE, 90, 51},
+		{GUtils::PathSegment::Type::LINE, 103, 51}
+	});
+	renderer.copy_image(small_image.data(), 0);
+	if(renderer.x() != 100 || renderer.y() != 50 || renderer.width() != 8 || renderer.height() != 6)
+		throw std::logic_error("Area not set");
+	if(pixel(small_image, 8 << 2, 2, 2) != 0xff00ff00 || pixel(small_image, 8 << 2, 7, 5) != 0xff00ff00 || pixel(small_image, 8 << 2, 1, 3) ||
+		pixel(small_image, 8 << 2, 0, 0) != 0xff0000ff || pixel(small_image, 8 << 2, 2, 1) != 0xff0000ff || pixel(small_image, 8 << 2, 4, 0))
+		throw std::logic_error("Area not drawn at position");
+	std::cout << "Drawing with " << renderer.width() << "x" << renderer.height() << " renderer passed" << std::endl;
+	return 0;
+}
@@ -0,0 +1,185 @@
+/*
+Project: SSBRenderer
+File: software.cpp
+
+Copyright (c) 2015, Christoph "Youka" Spanknebel
+
+This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+    1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+    2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+    3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../Renderer.hpp"
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#ifdef TEST_CAIRO_PARITY
+	#include <cairo.h>
+#endif
+
+// Exact pixel coverage (A8) of concave polygon below, by clipping it with every pixel square
+static const unsigned char reference[14][14] = {
+	{  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,  42,  36,   5,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0, 127, 255, 252, 223, 189, 155, 122,  88,  54,  20,   0,   0,   0},
+	{  0,  63, 255, 255, 255, 255, 255, 255, 255, 255, 255, 177,  29,   0},
+	{  0,   7, 246, 255, 255, 255, 255, 255, 255, 191,  64,   0,   0,   0},
+	{  0,   0, 189, 255, 255, 255, 255, 191,  64,   0,   0,   0,   0,   0},
+	{  0,   0, 125, 255, 255, 255,  77,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,  60, 255, 255, 214,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,   6, 245, 255, 130,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,   0, 187, 255,  47,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,   0, 122, 218,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,   0,  58, 134,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,   0,   5,  42,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+	{  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0}
+};
+
+// Alpha of image copied from renderer
+static std::vector<unsigned char> image_alpha(Backend::Renderer& renderer){
+	std::vector<unsigned char> image(renderer.width() * renderer.height() * 4), alpha(renderer.width() * renderer.height());
+	renderer.copy_image(image.data(), 0);
+	for(size_t i = 0; i < alpha.size(); ++i){
+		uint32_t value;
+		std::memcpy(&value, image.data() + (i << 2), sizeof(value));
+		alpha[i] = value >> 24;
+	}
+	return alpha;
+}
+
+#ifdef TEST_CAIRO_PARITY
+// Coverage (A8) of path filled (zero line width) or stroked by cairo, which the cairo backend draws with
+static std::vector<unsigned char> cairo_coverage(const std::vector<GUtils::PathSegment>& path, double line_width, unsigned width, unsigned height){
+	cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
+	cairo_t* ctx = cairo_create(surface);
+	for(const GUtils::PathSegment& segment : path)
+		switch(segment.type){
+			case GUtils::PathSegment::Type::MOVE: cairo_move_to(ctx, segment.x, segment.y); break;
+			case GUtils::PathSegment::Type::LINE:
+			case GUtils::PathSegment::Type::CURVE: cairo_line_to(ctx, segment.x, segment.y); break;
+			case GUtils::PathSegment::Type::CLOSE: cairo_close_path(ctx); break;
+		}
+	if(line_width > 0)
+		cairo_set_line_width(ctx, line_width),
+		cairo_set_line_cap(ctx, CAIRO_LINE_CAP_BUTT),
+		cairo_set_line_join(ctx, CAIRO_LINE_JOIN_BEVEL),
+		cairo_stroke(ctx);
+	else
+		cairo_set_fill_rule(ctx, CAIRO_FILL_RULE_WINDING),
+		cairo_fill(ctx);
+	cairo_destroy(ctx),
+	cairo_surface_flush(surface);
+	std::vector<unsigned char> coverage(width * height);
+	const unsigned char* data = cairo_image_surface_get_data(surface);
+	const int stride = cairo_image_surface_get_stride(surface);
+	for(unsigned y = 0; y < height; ++y)
+		std::memcpy(coverage.data() + y * width, data + y * stride, width);
+	cairo_surface_destroy(surface);
+	return coverage;
+}
+
+// Compare coverages within tolerance (rasterizers differ in sampling, not in shape)
+static void compare_coverage(const char* name, const std::vector<unsigned char>& coverage, const std::vector<unsigned char>& expected, int max_tolerance){
+	int max_diff = 0;
+	double diff_sum = 0;
+	for(size_t i = 0; i < coverage.size(); ++i){
+		const int diff = std::abs(static_cast<int>(coverage[i]) - expected[i]);
+		max_diff = std::max(max_diff, diff),
+		diff_sum += diff;
+	}
+	std::cout << name << " coverage difference to cairo: maximal " << max_diff << ", mean " << diff_sum / coverage.size() << std::endl;
+	if(max_diff > max_tolerance || diff_sum / coverage.size() > 2)
+		throw std::logic_error(std::string(name) + " coverage differs from cairo");
+}
+#endif
+
+int main(){
+	// Fill polygon with slanted edges & concave corner
+	Backend::Renderer renderer(14, 14);
+	renderer.set_fill_color(1, 1, 1, 1);
+	renderer.fill_path({
+		{GUtils::PathSegment::Type::MOVE, 1.3, 1.7},
+		{GUtils::PathSegment::Type::LINE, 12.6, 3.2},
+		{GUtils::PathSegment::Type::LINE, 6.2, 6.4},
+		{GUtils::PathSegment::Type::LINE, 4.1, 12.8},
+		{GUtils::PathSegment::Type::CLOSE, 0, 0}
+	});
+	// Compare rasterized coverage (alpha of opaque color) with reference
+	const std::vector<unsigned char> alpha = image_alpha(renderer);
+	int max_diff = 0;
+	for(unsigned y = 0; y < 14; ++y)
+		for(unsigned x = 0; x < 14; ++x){
+			const int diff = std::abs(static_cast<int>(alpha[y * 14 + x]) - reference[y][x]);
+			if(diff > max_diff)
+				max_diff = diff;
+		}
+	std::cout << "Maximal coverage difference to reference: " << max_diff << std::endl;
+	if(max_diff > 2)
+		throw std::logic_error("Rasterized coverage differs from reference");
+#ifdef TEST_CAIRO_PARITY
+	// Same drawings by cairo (backends share one class, so the cairo backend can't be linked beside this one; cairo itself stands in)
+	const unsigned size = 32;
+	const std::vector<GUtils::PathSegment> shape{	// Star with hole (inner contour reversed)
+		{GUtils::PathSegment::Type::MOVE, 16, 1.5},
+		{GUtils::PathSegment::Type::LINE, 20.3, 11.2},
+		{GUtils::PathSegment::Type::LINE, 30.6, 12.1},
+		{GUtils::PathSegment::Type::LINE, 22.8, 19.1},
+		{GUtils::PathSegment::Type::LINE, 25.1, 29.4},
+		{GUtils::PathSegment::Type::LINE, 16, 24.1},
+		{GUtils::PathSegment::Type::LINE, 6.9, 29.4},
+		{GUtils::PathSegment::Type::LINE, 9.2, 19.1},
+		{GUtils::PathSegment::Type::LINE, 1.4, 12.1},
+		{GUtils::PathSegment::Type::LINE, 11.7, 11.2},
+		{GUtils::PathSegment::Type::CLOSE, 0, 0},
+		{GUtils::PathSegment::Type::MOVE, 13.5, 14.5},
+		{GUtils::PathSegment::Type::LINE, 16.2, 20.3},
+		{GUtils::PathSegment::Type::LINE, 18.7, 14.5},
+		{GUtils::PathSegment::Type::CLOSE, 0, 0}
+	}, zigzag{
+		{GUtils::PathSegment::Type::MOVE, 2.5, 28.2},
+		{GUtils::PathSegment::Type::LINE, 9.3, 4.1},
+		{GUtils::PathSegment::Type::LINE, 16.1, 27.6},
+		{GUtils::PathSegment::Type::LINE, 22.7, 3.9},
+		{GUtils::PathSegment::Type::LINE, 29.4, 28.8}
+	}, band{
+		{GUtils::PathSegment::Type::MOVE, 0, 8.3},
+		{GUtils::PathSegment::Type::LINE, 32, 14.9},
+		{GUtils::PathSegment::Type::LINE, 32, 23.6},
+		{GUtils::PathSegment::Type::LINE, 0, 17.2},
+		{GUtils::PathSegment::Type::CLOSE, 0, 0}
+	};
+	renderer.set_size(size, size);
+	// Fill
+	renderer.fill_path(shape);
+	compare_coverage("Fill", image_alpha(renderer), cairo_coverage(shape, 0, size, size), 32);
+	// Stroke (outlines of segments & joins overlapping inside a pixel add up in accumulated coverage, cairo unites them exactly)
+	renderer.clear_image(),
+	renderer.set_line_color(1, 1, 1, 1),
+	renderer.set_line_width(2.5),
+	renderer.set_line_cap(Backend::Renderer::LineCap::FLAT),
+	renderer.set_line_join(Backend::Renderer::LineJoin::BEVEL),
+	renderer.stroke_path(zigzag);
+	compare_coverage("Stroke", image_alpha(renderer), cairo_coverage(zigzag, 2.5, size, size), 96);
+	// Fill through stencil (coverages multiply)
+	renderer.clear_image(),
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::SET),
+	renderer.fill_path(band),
+	renderer.set_stencil_mode(Backend::Renderer::StencilMode::INSIDE),
+	renderer.fill_path(shape);
+	const std::vector<unsigned char> stencil_coverage = cairo_coverage(band, 0, size, size);
+	std::vector<unsigned char> stenciled_coverage = cairo_coverage(shape, 0, size, size);
+	for(size_t i = 0; i < stenciled_coverage.size(); ++i)
+		stenciled_coverage[i] = (stenciled_coverage[i] * stencil_coverage[i] + 127) / 255;
+	compare_coverage("Stencil", image_alpha(renderer), stenciled_coverage, 32);
+#else
+	// Parity with cairo backend checked just when cairo is available (see CMake's cairo dependency options)
+	std::cout << "Cairo parity not checked (built without cairo)" << std::endl;
+#endif
+	return 0;
+}
@@ -20,9 +20,17 @@ Permission is granted to anyone to use this software for any purpose, including
 	#include <ext/stdio_filebuf.h>
 #endif
 #include "utf8.hpp"
-#ifndef _WIN32
+#include <limits>
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
 	#include <limits.h> // PATH_MAX
 	#include <libgen.h> // dirname
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
 #endif
 
 namespace stdex{
@@ -77,8 +85,102 @@ namespace stdex{
 #endif
 	};
 
+	// Read-only memory mapping of a whole file which accepts utf-8 filename
+	class mapped_file{
+		private:
+			const char* file_data = nullptr;
+			size_t file_size = 0;
+#ifdef _WIN32
+			HANDLE file = INVALID_HANDLE_VALUE, mapping = NULL;
+#else
+			int file = -1;
+#endif
+		public:
+			mapped_file() = default;
+			explicit mapped_file(const std::string& filename){this->open(filename);}
+			~mapped_file(){this->close();}
+			// No copy&move (-> mapping handles)
+			mapped_file(const mapped_file&) = delete;
+			mapped_file(mapped_file&&) = delete;
+			mapped_file& operator=(const mapped_file&) = delete;
+			mapped_file& operator=(mapped_file&&) = delete;
+			// Map file content into memory (empty files have no data but are open)
+			bool open(const std::string& filename){
+				this->close();
+#ifdef _WIN32
+				this->file = CreateFileW(Utf8::to_utf16(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+				if(this->file == INVALID_HANDLE_VALUE)
+					return false;
+				LARGE_INTEGER size;
+				if(!GetFileSizeEx(this->file, &size) || static_cast<unsigned long long>(size.QuadPart) > (std::numeric_limits<size_t>::max)()){
+					this->close();
+					return false;
+				}
+				if(size.QuadPart > 0){
+					if(!(this->mapping = CreateFileMappingW(this->file, NULL, PAGE_READONLY, 0, 0, NULL)) ||
+						!(this->file_data = static_cast<const char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0)))){
+						this->close();
+						return false;
+					}
+					this->file_size = static_cast<size_t>(size.QuadPart);
+				}
+#else
+				this->file = ::open(filename.c_str(), O_RDONLY);
+				if(this->file == -1)
+					return false;
+				struct stat info;
+				if(fstat(this->file, &info) != 0 || static_cast<unsigned long long>(info.st_size) > std::numeric_limits<size_t>::max()){
+					this->close();
+					return false;
+				}
+				if(info.st_size > 0){
+					void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, this->file, 0);
+					if(data == MAP_FAILED){
+						this->close();
+						return false;
+					}
+					madvise(data, info.st_size, MADV_SEQUENTIAL);
+					this->file_data = static_cast<const char*>(data),
+					this->file_size = info.st_size;
+				}
+#endif
+				return true;
+			}
+			void close(){
+#ifdef _WIN32
+				if(this->file_data)
+					UnmapViewOfFile(this->file_data);
+				if(this->mapping)
+					CloseHandle(this->mapping),
+					this->mapping = NULL;
+				if(this->file != INVALID_HANDLE_VALUE)
+					CloseHandle(this->file),
+					this->file = INVALID_HANDLE_VALUE;
+#else
+				if(this->file_data)
+					munmap(const_cast<char*>(this->file_data), this->file_size);
+				if(this->file != -1)
+					::close(this->file),
+					this->file = -1;
+#endif
+				this->file_data = nullptr,
+				this->file_size = 0;
+			}
+			// File state & content
+			bool is_open() const{
+#ifdef _WIN32
+				return this->file != INVALID_HANDLE_VALUE;
+#else
+				return this->file != -1;
+#endif
+			}
+			explicit operator bool() const{return this->is_open();}
+			const char* data() const{return this->file_data;}
+			size_t size() const{return this->file_size;}
+	};
+
 	// Extracts absolute directory path from filepath
-	std::string get_file_dir(const std::string& filename){
+	static inline std::string get_file_dir(const std::string& filename){
 #ifdef _WIN32
 		wchar_t path[_MAX_PATH];
 		if(_wfullpath(path, Utf8::to_utf16(filename).c_str(), sizeof(path)/sizeof(path[0]))){
@@ -15,6 +15,11 @@ Permission is granted to anyone to use this software for any purpose, including
 #pragma once
 
 #include <deque>
+#include <vector>
+#include <list>
+#include <tuple>
+#include <unordered_map>
+#include <functional>
 #include <algorithm>
 
 namespace stdex{
@@ -89,8 +94,70 @@ namespace stdex{
 					this->memory.pop_back();
 				this->memory.push_front({key, std::forward<Value>(value)});
 			}
+			void remove(const Key& key){
+				auto iter = this->find(key);
+				if(iter != this->memory.end())
+					this->memory.erase(iter);
+			}
 			void clear(){
 				this->memory.clear();
 			}
 	};
+
+	// LRU cache with key-value pairs limited by sum of value sizes (e.g. bytes)
+	template<typename Key, typename Value, typename Hash = std::hash<Key>>
+	class SizedCache{
+		private:
+			// Data storage (most recently used first) & index
+			const size_t budget;
+			size_t used = 0;
+			std::list<std::tuple<Key,Value,size_t>> memory;
+			std::unordered_map<Key, typename decltype(memory)::iterator, Hash> index;
+		public:
+			// Ctor
+			explicit SizedCache(size_t budget) : budget(budget){}
+			// Requests
+			size_t size() const{
+				return this->memory.size();
+			}
+			size_t used_size() const{
+				return this->used;
+			}
+			bool contains(const Key& key) const{
+				return this->index.find(key) != this->index.end();
+			}
+			// Modifications
+			Value get(const Key& key){
+				auto iter = this->index.find(key);
+				if(iter != this->index.end()){
+					this->memory.splice(this->memory.begin(), this->memory, iter->second);
+					return std::get<1>(*iter->second);
+				}
+				return Value();
+			}
+			void add(const Key& key, Value value, size_t value_size){
+				this->remove(key);
+				if(value_size > this->budget)
+					return;
+				this->memory.emplace_front(key, std::move(value), value_size),
+				this->index[key] = this->memory.begin(),
+				this->used += value_size;
+				while(this->used > this->budget)
+					this->used -= std::get<2>(this->memory.back()),
+					this->index.erase(std::get<0>(this->memory.back())),
+					this->memory.pop_back();
+			}
+			void remove(const Key& key){
+				auto iter = this->index.find(key);
+				if(iter != this->index.end())
+					this->used -= std::get<2>(*iter->second),
+					this->memory.erase(iter->second),
+					this->index.erase(iter);
+			}
+			void clear(){
+				this->memory.clear(),
+				this->index.clear(),
+				this->used = 0;
+			}
+	};
 }
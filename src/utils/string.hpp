@@ -16,56 +16,305 @@ Permission is granted to anyone to use this software for any purpose, including
 
 #include <sstream>
 #include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <locale>
+#include <cmath>
+#include <cctype>
 
 namespace stdex{
+	// Non-owning view on constant characters (subset of C++17 std::string_view)
+	class string_view{
+		public:
+			using size_type = std::string::size_type;
+			using const_iterator = const char*;
+			using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+			static const size_type npos = std::string::npos;
+		private:
+			const char* ptr;
+			size_type len;
+		public:
+			// Ctors
+			string_view() : ptr(nullptr), len(0){}
+			string_view(const char* s, size_type n) : ptr(s), len(n){}
+			string_view(const char* s) : ptr(s), len(std::char_traits<char>::length(s)){}
+			string_view(const std::string& s) : ptr(s.data()), len(s.length()){}
+			// Getters
+			const char* data() const{return this->ptr;}
+			size_type size() const{return this->len;}
+			size_type length() const{return this->len;}
+			bool empty() const{return this->len == 0;}
+			const_iterator begin() const{return this->ptr;}
+			const_iterator end() const{return this->ptr + this->len;}
+			const_reverse_iterator rbegin() const{return const_reverse_iterator(this->end());}
+			const_reverse_iterator rend() const{return const_reverse_iterator(this->begin());}
+			const char& operator[](size_type pos) const{return this->ptr[pos];}
+			const char& front() const{return this->ptr[0];}
+			const char& back() const{return this->ptr[this->len-1];}
+			explicit operator std::string() const{return std::string(this->ptr, this->len);}
+			// Modifications
+			void remove_prefix(size_type n){
+				this->ptr += n,
+				this->len -= n;
+			}
+			void remove_suffix(size_type n){
+				this->len -= n;
+			}
+			string_view substr(size_type pos, size_type n = npos) const{
+				pos = std::min(pos, this->len);
+				return string_view(this->ptr + pos, std::min(n, this->len - pos));
+			}
+			// Search
+			size_type find(const char c, size_type pos = 0) const{
+				if(pos >= this->len)
+					return npos;
+				const void* found = ::memchr(this->ptr + pos, c, this->len - pos);
+				return found ? static_cast<const char*>(found) - this->ptr : npos;
+			}
+			size_type find(string_view s, size_type pos = 0) const{
+				if(pos > this->len)
+					return npos;
+				const char* found = std::search(this->ptr + pos, this->ptr + this->len, s.ptr, s.ptr + s.len);
+				return found != this->ptr + this->len || s.len == 0 ? found - this->ptr : npos;
+			}
+			size_type find_first_of(string_view chars, size_type pos = 0) const{
+				for(; pos < this->len; ++pos)
+					if(chars.find(this->ptr[pos]) != npos)
+						return pos;
+				return npos;
+			}
+			size_type find_first_not_of(string_view chars, size_type pos = 0) const{
+				for(; pos < this->len; ++pos)
+					if(chars.find(this->ptr[pos]) == npos)
+						return pos;
+				return npos;
+			}
+			// Comparison
+			int compare(string_view s) const{
+				const int result = std::char_traits<char>::compare(this->ptr, s.ptr, std::min(this->len, s.len));
+				return result ? result : (this->len < s.len ? -1 : (this->len > s.len ? 1 : 0));
+			}
+			int compare(size_type pos, size_type n, string_view s) const{
+				return this->substr(pos, n).compare(s);
+			}
+	};
+	static inline bool operator==(string_view s1, string_view s2){
+		return s1.size() == s2.size() && std::char_traits<char>::compare(s1.data(), s2.data(), s1.size()) == 0;
+	}
+	static inline bool operator!=(string_view s1, string_view s2){
+		return !(s1 == s2);
+	}
+
+	// Extracts next token until delimiter from view (like std::getline from streams)
+	static inline bool getline(string_view& src, string_view& token, const char delimiter){
+		if(src.empty())
+			return false;
+		const string_view::size_type pos = src.find(delimiter);
+		if(pos == string_view::npos)
+			token = src,
+			src = string_view(src.end(), 0);
+		else
+			token = src.substr(0, pos),
+			src.remove_prefix(pos+1);
+		return true;
+	}
+
+	// Input stream on constant memory (no copy)
+	class imemstream : private std::streambuf, public std::istream{
+		public:
+			imemstream(string_view s) : std::istream(static_cast<std::streambuf*>(this)){
+				char* const data = const_cast<char*>(s.data());
+				this->setg(data, data, data + s.size());
+			}
+	};
+
+	// Result of number parsing
+	enum class NumberStatus{OK, INVALID, OUT_OF_RANGE};
+
+	// Parses decimal integer from beginning of characters range (locale-independent), moves range start behind number
+	template<typename T>
+	static inline typename std::enable_if<std::is_integral<T>::value, NumberStatus>::type parse_number(const char*& first, const char* last, T& dst){
+		const char* it = first;
+		const bool negative = it != last && *it == '-';
+		if(it != last && (*it == '-' || *it == '+'))
+			++it;
+		if(negative && !std::is_signed<T>::value)
+			return NumberStatus::INVALID;
+		// Accumulate digits with range check (absolute minimum of signed types is maximum + 1)
+		const unsigned long long limit = static_cast<unsigned long long>(std::numeric_limits<T>::max()) + negative;
+		unsigned long long value = 0;
+		bool overflow = false;
+		const char* const digits_start = it;
+		for(; it != last && *it >= '0' && *it <= '9'; ++it){
+			const unsigned digit = *it - '0';
+			if(value > (limit - digit) / 10)
+				overflow = true;
+			else
+				value = value * 10 + digit;
+		}
+		if(it == digits_start)
+			return NumberStatus::INVALID;
+		first = it;
+		if(overflow)
+			return NumberStatus::OUT_OF_RANGE;
+		dst = negative ? (value ? static_cast<T>(-static_cast<long long>(value - 1) - 1) : 0) : static_cast<T>(value);
+		return NumberStatus::OK;
+	}
+
+	// Parses decimal floating point number from beginning of characters range (locale-independent), moves range start behind number
+	template<typename T>
+	static inline typename std::enable_if<std::is_floating_point<T>::value, NumberStatus>::type parse_number(const char*& first, const char* last, T& dst){
+		const char* it = first;
+		const bool negative = it != last && *it == '-';
+		if(it != last && (*it == '-' || *it == '+'))
+			++it;
+		// Collect up to 19 significant digits as integer mantissa
+		unsigned long long mantissa = 0;
+		int digits = 0, exponent = 0;
+		bool any_digits = false, truncated = false;
+		for(; it != last && *it >= '0' && *it <= '9'; ++it){
+			any_digits = true;
+			if(digits < 19)
+				mantissa = mantissa * 10 + (*it - '0'),
+				digits += mantissa != 0;
+			else
+				exponent++,
+				truncated = true;
+		}
+		if(it != last && *it == '.')
+			for(++it; it != last && *it >= '0' && *it <= '9'; ++it){
+				any_digits = true;
+				if(digits < 19)
+					mantissa = mantissa * 10 + (*it - '0'),
+					digits += mantissa != 0,
+					exponent--;
+				else
+					truncated = true;
+			}
+		if(!any_digits)
+			return NumberStatus::INVALID;
+		// Add exponent part (just in case of following digits)
+		if(it != last && (*it == 'e' || *it == 'E')){
+			const char* exp_it = it + 1;
+			const bool exp_negative = exp_it != last && *exp_it == '-';
+			if(exp_it != last && (*exp_it == '-' || *exp_it == '+'))
+				++exp_it;
+			if(exp_it != last && *exp_it >= '0' && *exp_it <= '9'){
+				int exp_value = 0;
+				for(; exp_it != last && *exp_it >= '0' && *exp_it <= '9'; ++exp_it)
+					if(exp_value < 100000)
+						exp_value = exp_value * 10 + (*exp_it - '0');
+				exponent += exp_negative ? -exp_value : exp_value,
+				it = exp_it;
+			}
+		}
+		// Convert exactly representable mantissas & powers of ten directly, everything else by classic locale stream
+		static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+		double value;
+		if(mantissa == 0)
+			value = 0;
+		else if(!truncated && mantissa <= 1ULL << 53 && exponent >= -22 && exponent <= 22)
+			value = exponent < 0 ? mantissa / powers_of_ten[-exponent] : mantissa * powers_of_ten[exponent];
+		else{
+			imemstream s(string_view(first, it - first));
+			static_cast<std::istream&>(s).imbue(std::locale::classic());
+			if(!(s >> std::noskipws >> value)){
+				first = it;
+				return NumberStatus::OUT_OF_RANGE;
+			}
+			value = std::abs(value);
+		}
+		first = it;
+		if(value > std::numeric_limits<T>::max())
+			return NumberStatus::OUT_OF_RANGE;
+		dst = static_cast<T>(negative ? -value : value);
+		return NumberStatus::OK;
+	}
+
+	// Parses hexadecimal integer from beginning of characters range, moves range start behind number
+	template<typename T>
+	static inline NumberStatus parse_hex_number(const char*& first, const char* last, T& dst){
+		static_assert(std::is_integral<T>::value, "Hexadecimal numbers are integers");
+		const char* it = first;
+		// Skip optional prefix
+		if(last - it > 2 && it[0] == '0' && (it[1] == 'x' || it[1] == 'X') && std::isxdigit(static_cast<unsigned char>(it[2])))
+			it += 2;
+		// Accumulate digits with range check
+		const unsigned long long limit = std::numeric_limits<T>::max();
+		unsigned long long value = 0;
+		bool overflow = false;
+		const char* const digits_start = it;
+		for(; it != last; ++it){
+			unsigned digit;
+			if(*it >= '0' && *it <= '9')
+				digit = *it - '0';
+			else if(*it >= 'a' && *it <= 'f')
+				digit = *it - 'a' + 10;
+			else if(*it >= 'A' && *it <= 'F')
+				digit = *it - 'A' + 10;
+			else
+				break;
+			if(value > (limit - digit) >> 4)
+				overflow = true;
+			else
+				value = value << 4 | digit;
+		}
+		if(it == digits_start)
+			return NumberStatus::INVALID;
+		first = it;
+		if(overflow)
+			return NumberStatus::OUT_OF_RANGE;
+		dst = static_cast<T>(value);
+		return NumberStatus::OK;
+	}
+
 	// Converts string to number
 	template<typename T>
-	static inline bool string_to_number(const std::string& src, T& dst){
-		std::istringstream s(src);
-		return s >> std::noskipws >> dst && s.eof();
+	static inline bool string_to_number(string_view src, T& dst){
+		const char* it = src.begin();
+		return parse_number(it, src.end(), dst) == NumberStatus::OK && it == src.end();
 	}
 
 	// Converts string to number pair
 	template<typename T>
-	static inline bool string_to_number(const std::string& src, T& dst1, T& dst2){
-		std::string::size_type pos;
-		return (pos = src.find(',')) != std::string::npos &&
-				string_to_number(src.substr(0, pos), dst1) &&
-				string_to_number(src.substr(pos+1), dst2);
+	static inline bool string_to_number(string_view src, T& dst1, T& dst2){
+		const char* it = src.begin();
+		return parse_number(it, src.end(), dst1) == NumberStatus::OK && it != src.end() && *it++ == ',' &&
+				parse_number(it, src.end(), dst2) == NumberStatus::OK && it == src.end();
 	}
 
 	// Converts hex string to number
 	template<typename T>
-	static inline bool hex_string_to_number(const std::string& src, T& dst){
-		std::istringstream s(src);
-		return s >> std::noskipws >> std::hex >> dst && s.eof();
+	static inline bool hex_string_to_number(string_view src, T& dst){
+		const char* it = src.begin();
+		return parse_hex_number(it, src.end(), dst) == NumberStatus::OK && it == src.end();
 	}
 	// Converts hex string to number pair
 	template<typename T>
-	static inline bool hex_string_to_number(const std::string& src, T& dst1, T& dst2){
-		std::string::size_type pos;
-		return (pos = src.find(',')) != std::string::npos &&
-				hex_string_to_number(src.substr(0, pos), dst1) &&
-				hex_string_to_number(src.substr(pos+1), dst2);
+	static inline bool hex_string_to_number(string_view src, T& dst1, T& dst2){
+		const char* it = src.begin();
+		return parse_hex_number(it, src.end(), dst1) == NumberStatus::OK && it != src.end() && *it++ == ',' &&
+				parse_hex_number(it, src.end(), dst2) == NumberStatus::OK && it == src.end();
 	}
 	// Converts hex string to four numbers
 	template<typename T>
-	static inline bool hex_string_to_number(const std::string& src, T& dst1, T& dst2, T& dst3, T& dst4){
-		std::string::size_type pos1, pos2;
-		return (pos1 = src.find(',')) != std::string::npos &&
-				hex_string_to_number(src.substr(0, pos1), dst1) &&
-				(pos2 = src.find(',', pos1+1)) != std::string::npos &&
-				hex_string_to_number(src.substr(pos1+1, pos2-(pos1+1)), dst2) &&
-				(pos1 = src.find(',', pos2+1)) != std::string::npos &&
-				hex_string_to_number(src.substr(pos2+1, pos1-(pos2+1)), dst3) &&
-				hex_string_to_number(src.substr(pos1+1), dst4);
+	static inline bool hex_string_to_number(string_view src, T& dst1, T& dst2, T& dst3, T& dst4){
+		const char* it = src.begin();
+		return parse_hex_number(it, src.end(), dst1) == NumberStatus::OK && it != src.end() && *it++ == ',' &&
+				parse_hex_number(it, src.end(), dst2) == NumberStatus::OK && it != src.end() && *it++ == ',' &&
+				parse_hex_number(it, src.end(), dst3) == NumberStatus::OK && it != src.end() && *it++ == ',' &&
+				parse_hex_number(it, src.end(), dst4) == NumberStatus::OK && it == src.end();
 	}
 
 	// Find character in string which isn't escaped by character '\'
-	static inline std::string::size_type find_non_escaped_character(const std::string& s, const char c, const std::string::size_type pos_start = 0){
-		std::string::size_type pos_end;
+	static inline string_view::size_type find_non_escaped_character(string_view s, const char c, const string_view::size_type pos_start = 0){
+		string_view::size_type pos_end;
 		for(auto search_pos_start = pos_start;
-			(pos_end = s.find(c, search_pos_start)) != std::string::npos && pos_end > 0 && s[pos_end-1] == '\\';
+			(pos_end = s.find(c, search_pos_start)) != string_view::npos && pos_end > 0 && s[pos_end-1] == '\\';
 			search_pos_start = pos_end + 1);
 		return pos_end;
 	}
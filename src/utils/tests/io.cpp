@@ -20,6 +20,11 @@ int main(){
 	stdex::fstream file(filename, stdex::fstream::out);
 	if(!file)
 		throw std::invalid_argument("Couldn't create file with unicode name");
+	file << "#EVENTS";
+	file.close();
+	stdex::mapped_file mapping(filename);
+	if(!mapping || mapping.size() != 7 || std::string(mapping.data(), mapping.size()) != "#EVENTS")
+		throw std::invalid_argument("Couldn't map file with unicode name");
 	file.open(filename, stdex::fstream::in);
 	if(!file)
 		throw std::invalid_argument("Couldn't open file with unicode name");
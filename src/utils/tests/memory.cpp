@@ -13,6 +13,7 @@ Permission is granted to anyone to use this software for any purpose, including
 */
 
 #include "../memory.hpp"
+#include <string>
 #include <stdexcept>
 #include <iostream>
 
@@ -25,6 +26,19 @@ int main(){
 		throw std::logic_error("Found outdated value in cache");
 	if(cache.get('B') != 2)
 		throw std::logic_error("Invalid cache entry");
+	cache.remove('B');
+	if(cache.contains('B') || cache.size() != 2)
+		throw std::logic_error("Removed cache entry still existing");
+	stdex::SizedCache<std::string, int> sized_cache(10);
+	sized_cache.add("A", 1, 4),
+	sized_cache.add("B", 2, 4),
+	sized_cache.get("A"),
+	sized_cache.add("C", 3, 4);
+	if(sized_cache.contains("B") || !sized_cache.contains("A") || sized_cache.used_size() != 8)
+		throw std::logic_error("Sized cache didn't drop least recently used entry");
+	sized_cache.add("D", 4, 11);
+	if(sized_cache.contains("D") || sized_cache.size() != 2)
+		throw std::logic_error("Sized cache accepted entry over budget");
 	auto keys = cache.keys();
 	for(auto& key : keys)
 		std::cout << key << ':' << cache.get(key) << std::endl;
@@ -21,6 +21,13 @@ int main(){
 		throw std::logic_error("String to number conversion failed");
 	if(stdex::hex_string_to_number("1g", a) || !stdex::hex_string_to_number("00,ff,a5,1E", a, b, c, d) || a != 0x00 || b != 0xff || c != 0xa5 || d != 0x1e)
 		throw std::logic_error("Hexadecimal string to number conversion failed");
+	const char* number = "1.5e3,70000", * number_end = number + std::strlen(number);
+	double e;
+	short f;
+	if(stdex::parse_number(number, number_end, e) != stdex::NumberStatus::OK || e != 1500 || *number++ != ',' ||
+		stdex::parse_number(number, number_end, f) != stdex::NumberStatus::OUT_OF_RANGE || number != number_end ||
+		!stdex::string_to_number(".25", e) || e != 0.25 || stdex::string_to_number("1e400", e) || stdex::string_to_number("-", e))
+		throw std::logic_error("Number parsing failed");
 	if(stdex::find_non_escaped_character("{123}{abc", '{', 1) != 5)
 		throw std::logic_error("Couldn't find correct escaped character");
         std::string s("Hello world! All correct, world?");